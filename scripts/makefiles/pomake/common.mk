@@ -21,6 +21,7 @@ OBJECTS=\
 	$(BUILD_DIR)/parse/token/user.o \
 	$(BUILD_DIR)/semantic/asm.o \
 	$(BUILD_DIR)/semantic/dec.o \
+	$(BUILD_DIR)/semantic/eval.o \
 	$(BUILD_DIR)/semantic/expr.o \
 	$(BUILD_DIR)/semantic/phase.o \
 	$(BUILD_DIR)/semantic/stmt.o \
@@ -29,8 +30,10 @@ OBJECTS=\
 	$(BUILD_DIR)/codegen/chunk.o \
 	$(BUILD_DIR)/codegen/dec.o \
 	$(BUILD_DIR)/codegen/expr.o \
+	$(BUILD_DIR)/codegen/inline.o \
 	$(BUILD_DIR)/codegen/linear.o \
 	$(BUILD_DIR)/codegen/obj.o \
+	$(BUILD_DIR)/codegen/optimize.o \
 	$(BUILD_DIR)/codegen/pcode.o \
 	$(BUILD_DIR)/codegen/phase.o \
 	$(BUILD_DIR)/codegen/stmt.o \
@@ -213,6 +216,13 @@ $(BUILD_DIR)/semantic/dec.o: \
 	src/common.h \
 	src/gbuf.h
 	$(CC) -c $(OPTIONS) -Fo $@ $!
+$(BUILD_DIR)/semantic/eval.o: \
+	src/semantic/eval.c \
+	src/semantic/phase.h \
+	src/task.h \
+	src/common.h \
+	src/gbuf.h
+	$(CC) -c $(OPTIONS) -Fo $@ $!
 $(BUILD_DIR)/semantic/expr.o: \
 	src/semantic/expr.c \
 	src/parse/phase.h \
@@ -280,6 +290,14 @@ $(BUILD_DIR)/codegen/expr.o: \
 	src/codegen/linear.h \
 	src/codegen/pcode.h
 	$(CC) -c $(OPTIONS) -Fo $@ $!
+$(BUILD_DIR)/codegen/inline.o: \
+	src/codegen/inline.c \
+	src/codegen/phase.h \
+	src/task.h \
+	src/common.h \
+	src/gbuf.h \
+	src/codegen/linear.h
+	$(CC) -c $(OPTIONS) -Fo $@ $!
 $(BUILD_DIR)/codegen/linear.o: \
 	src/codegen/linear.c \
 	src/codegen/phase.h \
@@ -298,6 +316,15 @@ $(BUILD_DIR)/codegen/obj.o: \
 	src/codegen/linear.h \
 	src/codegen/pcode.h
 	$(CC) -c $(OPTIONS) -Fo $@ $!
+$(BUILD_DIR)/codegen/optimize.o: \
+	src/codegen/optimize.c \
+	src/codegen/phase.h \
+	src/task.h \
+	src/common.h \
+	src/gbuf.h \
+	src/codegen/linear.h \
+	src/codegen/pcode.h
+	$(CC) -c $(OPTIONS) -Fo $@ $!
 $(BUILD_DIR)/codegen/pcode.o: \
 	src/codegen/pcode.c \
 	src/common.h \
@@ -76,6 +76,7 @@ enum {
    F_VAR,
    F_UNREACHABLE,
    F_UPMOST,
+   F_MEMBERCOUNT,
 };
 
 struct saver {
@@ -319,7 +320,15 @@ static void save_structure( struct saver* saver,
    if ( ! structure->anon ) {
       WN( saver, F_NAME, structure->name );
    }
+   // The member count lets the restorer size the member table up front.
+   int count = 0;
    struct structure_member* member = structure->member;
+   while ( member ) {
+      ++count;
+      member = member->next;
+   }
+   WV( saver, F_MEMBERCOUNT, &count );
+   member = structure->member;
    while ( member ) {
       if ( member->head_instance ) {
          save_structure_member( saver, member );
@@ -731,7 +740,8 @@ static void restore_namespace_path( struct restorer* restorer ) {
       struct ns_path* path = mem_alloc( sizeof( *path ) );
       const char* value = RS( restorer, F_TEXT );
       path->next = NULL;
-      path->text = t_intern_text( restorer->task, value, strlen( value ) );
+      path->atom = t_intern_atom( value, strlen( value ) );
+      path->text = path->atom->text;
       restore_pos( restorer, &path->pos );
       if ( head ) {
          tail->next = path;
@@ -749,7 +759,8 @@ static void restore_namespace_list( struct restorer* restorer ) {
    if ( restorer->ns_fragment->path ) {
       struct ns_path* path = restorer->ns_fragment->path;
       while ( path ) {
-         struct name* name = t_extend_name( restorer->ns->body, path->text );
+         struct name* name = t_extend_name_atom( restorer->ns->body,
+            path->atom );
          if ( ! name->object ) {
             struct ns* ns = t_alloc_ns( name );
             ns->object.pos = path->pos;
@@ -897,6 +908,9 @@ static struct structure* restore_structure( struct restorer* restorer ) {
       structure->anon = true;
    }
    structure->body = t_create_name();
+   int count = 0;
+   RV( restorer, F_MEMBERCOUNT, &count );
+   t_reserve_name_children( structure->body, count );
    while ( f_peek( restorer->r ) == F_STRUCTUREMEMBER ) {
       restore_structure_member( restorer, structure );
    }
@@ -918,7 +932,9 @@ static void restore_structure_member( struct restorer* restorer,
       RF( restorer, F_INSTANCE );
       struct structure_member* member = t_alloc_structure_member();
       restore_object( restorer, &member->object, NODE_STRUCTURE_MEMBER );
-      member->name = t_extend_name( structure->body, RS( restorer, F_NAME ) );
+      const char* name = RS( restorer, F_NAME );
+      member->name = t_extend_name_atom( structure->body,
+         t_intern_atom( name, strlen( name ) ) );
       member->enumeration = spec.enumeration;
       member->structure = spec.structure;
       member->path = spec.path;
@@ -962,7 +978,8 @@ static struct path* restore_path( struct restorer* restorer ) {
          struct path* path = mem_alloc( sizeof( *path ) );
          path->next = NULL;
          const char* value = RS( restorer, F_TEXT );
-         path->text = t_intern_text( restorer->task, value, strlen( value ) );
+         path->atom = t_intern_atom( value, strlen( value ) );
+         path->text = path->atom->text;
          restore_pos( restorer, &path->pos );
          RV( restorer, F_UPMOST, &path->upmost );
          if ( head ) {
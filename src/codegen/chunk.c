@@ -1179,7 +1179,9 @@ static void do_sary( struct codegen* codegen ) {
    while ( ! list_end( &i ) ) {
       struct func* func = list_data( &i );
       struct func_user* impl = func->impl;
-      write_sary_chunk( codegen, "FARY", impl->index, &impl->vars );
+      if ( impl->reachable ) {
+         write_sary_chunk( codegen, "FARY", impl->index, &impl->vars );
+      }
       list_next( &i );
    }
 }
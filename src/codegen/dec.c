@@ -39,16 +39,24 @@ static void nullify_array( struct codegen* codegen, int storage, int index,
 static void write_multi_initz_acs( struct codegen* codegen, struct var* var );
 static void assign_nested_func_indexes( struct codegen* codegen,
    struct func* nested_funcs );
+static void find_tail_calls( struct func* nested_funcs );
+static struct call* get_tail_call( struct return_stmt* stmt );
+static struct func* find_return_group( struct func* func );
 static void assign_nested_call_ids( struct codegen* codegen,
    struct func* nested_funcs );
+static void set_direct_return( struct func* nested_funcs, struct func* group,
+   bool direct_return );
 static void init_nestedfunc_writing( struct nestedfunc_writing* writing,
    struct func* nested_funcs, struct call* nested_calls, int temps_start );
 static void write_nested_funcs( struct codegen* codegen,
    struct nestedfunc_writing* writing );
 static void write_one_nestedfunc( struct codegen* codegen,
    struct nestedfunc_writing* writing, struct func* func );
+static int find_saved_vars( struct codegen* codegen,
+   struct nestedfunc_writing* writing, struct func* func,
+   struct c_node* body, int start_index, bool* saved );
 static void patch_nestedfunc_addresses( struct codegen* codegen,
-   struct func* func );
+   struct nestedfunc_writing* writing, struct func* func );
 
 void c_write_user_code( struct codegen* codegen ) {
    if ( codegen->null_handler ) {
@@ -61,10 +69,14 @@ void c_write_user_code( struct codegen* codegen ) {
       write_script( codegen, list_data( &i ) );
       list_next( &i );
    }
-   // Functions.
+   // Functions. Functions that cannot be reached are not written.
    list_iterate( &codegen->task->library_main->funcs, &i );
    while ( ! list_end( &i ) ) {
-      write_func( codegen, list_data( &i ) );
+      struct func* func = list_data( &i );
+      struct func_user* impl = func->impl;
+      if ( impl->reachable ) {
+         write_func( codegen, func );
+      }
       list_next( &i );
    }
    // When utilizing the Little-E format, where instructions can be of
@@ -125,9 +137,14 @@ static void write_script( struct codegen* codegen, struct script* script ) {
    script->offset = c_tell( codegen );
    if ( script->nested_funcs ) {
       assign_nested_func_indexes( codegen, script->nested_funcs );
+      if ( codegen->task->options->optimize >= OPTIMIZE_BASIC ) {
+         find_tail_calls( script->nested_funcs );
+      }
       assign_nested_call_ids( codegen, script->nested_funcs );
    }
    alloc_param_indexes( &record, script->params );
+   // Parameters keep their slots.
+   int param_size = record.start_index;
    alloc_funcscopevars_indexes( codegen, &record, &script->funcscope_vars );
    c_write_block( codegen, script->body );
    c_pcd( codegen, PCD_TERMINATE );
@@ -140,6 +157,9 @@ static void write_script( struct codegen* codegen, struct script* script ) {
       write_nested_funcs( codegen, &writing );
       script->size += writing.temps_size;
    }
+   else if ( codegen->task->options->optimize >= OPTIMIZE_BASIC ) {
+      script->size = c_pack_local_vars( codegen, param_size, script->size );
+   }
    c_flush_pcode( codegen );
 }
 
@@ -151,9 +171,14 @@ static void write_func( struct codegen* codegen, struct func* func ) {
    impl->obj_pos = c_tell( codegen );
    if ( impl->nested_funcs ) {
       assign_nested_func_indexes( codegen, impl->nested_funcs );
+      if ( codegen->task->options->optimize >= OPTIMIZE_BASIC ) {
+         find_tail_calls( impl->nested_funcs );
+      }
       assign_nested_call_ids( codegen, impl->nested_funcs );
    }
    alloc_param_indexes( &record, func->params );
+   // Parameters keep their slots.
+   int param_size = record.start_index;
    alloc_funcscopevars_indexes( codegen, &record, &impl->funcscope_vars );
    c_write_block( codegen, impl->body );
    if ( func->return_spec == SPEC_VOID && ! func->ref ) {
@@ -168,6 +193,9 @@ static void write_func( struct codegen* codegen, struct func* func ) {
       write_nested_funcs( codegen, &writing );
       impl->size += writing.temps_size;
    }
+   else if ( codegen->task->options->optimize >= OPTIMIZE_BASIC ) {
+      impl->size = c_pack_local_vars( codegen, param_size, impl->size );
+   }
    c_flush_pcode( codegen );
 }
 
@@ -176,7 +204,9 @@ static void init_func_record( struct func_record* record, struct func* func ) {
    record->start_index = 0;
    record->array_index = 0;
    record->size = 0;
+   record->inline_growth = 0;
    record->nested_func = false;
+   record->inlined = false;
 }
 
 static void alloc_param_indexes( struct func_record* func,
@@ -216,6 +246,81 @@ static void alloc_funcscopevars_indexes( struct codegen* codegen,
    }
 }
 
+// Writes the body of a function in place of a call to the function. The
+// arguments are on the stack. The parameters and local variables of the
+// function use the free script variables of the caller, and a return statement
+// jumps to the end of the body, leaving the return value on the stack.
+void c_write_inline_func( struct codegen* codegen, struct func* func ) {
+   struct func_user* impl = func->impl;
+   struct func_record* caller = codegen->func;
+   struct local_record* local_record = codegen->local_record;
+   struct func_record record;
+   init_func_record( &record, func );
+   if ( local_record ) {
+      record.start_index = local_record->index;
+      record.size = local_record->func_size;
+   }
+   else {
+      record.start_index = caller->start_index;
+      record.size = caller->size;
+   }
+   record.array_index = caller->array_index;
+   record.inline_growth = caller->inline_growth;
+   record.inlined = true;
+   int param_start = record.start_index;
+   alloc_param_indexes( &record, func->params );
+   alloc_funcscopevars_indexes( codegen, &record, &impl->funcscope_vars );
+   // Assign arguments to parameters.
+   int total_param_size = c_total_param_size( func );
+   int i = total_param_size - 1;
+   while ( i >= 0 ) {
+      c_pcd( codegen, PCD_ASSIGNSCRIPTVAR, param_start + i );
+      --i;
+   }
+   struct c_point* entry_point = c_create_point( codegen );
+   c_append_node( codegen, &entry_point->node );
+   // Body.
+   struct return_stmt* stmt = impl->returns;
+   while ( stmt ) {
+      stmt->epilogue_jump = NULL;
+      stmt = stmt->next;
+   }
+   codegen->func = &record;
+   codegen->local_record = NULL;
+   c_write_block( codegen, impl->body );
+   caller->inline_growth = record.inline_growth;
+   codegen->func = caller;
+   codegen->local_record = local_record;
+   struct c_point* exit_point = c_create_point( codegen );
+   c_append_node( codegen, &exit_point->node );
+   stmt = impl->returns;
+   while ( stmt ) {
+      if ( stmt->epilogue_jump ) {
+         stmt->epilogue_jump->point = exit_point;
+      }
+      stmt = stmt->next;
+   }
+   // A called function gets its local variables set to zero, so do the same
+   // for the variables that have no initializer.
+   c_seek_node( codegen, &entry_point->node );
+   struct list_iter k;
+   list_iterate( &impl->vars, &k );
+   while ( ! list_end( &k ) ) {
+      struct var* var = list_data( &k );
+      if ( var->storage == STORAGE_LOCAL && ! var->value ) {
+         for ( int slot = 0; slot < var->size; ++slot ) {
+            c_pcd( codegen, PCD_PUSHNUMBER, 0 );
+            c_pcd( codegen, PCD_ASSIGNSCRIPTVAR, var->index + slot );
+         }
+      }
+      list_next( &k );
+   }
+   c_seek_node( codegen, &exit_point->node );
+   if ( record.size > caller->size ) {
+      caller->size = record.size;
+   }
+}
+
 // Increases the space size of local variables by one, returning the index of
 // the space slot.
 int c_alloc_script_var( struct codegen* codegen ) {
@@ -556,19 +661,107 @@ static void assign_nested_func_indexes( struct codegen* codegen,
    }
 }
 
+// A return statement whose value is a call to a nested function can jump to
+// the called function instead of making a call. The calling function must not
+// save its variables on the stack, since nothing would restore them.
+static void find_tail_calls( struct func* nested_funcs ) {
+   struct func* func = nested_funcs;
+   while ( func ) {
+      struct func_user* impl = func->impl;
+      if ( impl->recursive != RECURSIVE_POSSIBLY &&
+         func->return_spec != SPEC_VOID && ! func->ref ) {
+         struct return_stmt* stmt = impl->returns;
+         while ( stmt ) {
+            struct call* call = get_tail_call( stmt );
+            if ( call ) {
+               call->nested_call->tail = true;
+               struct func* group = find_return_group( func );
+               struct func* callee_group = find_return_group( call->func );
+               if ( group != callee_group ) {
+                  struct func_user* group_impl = group->impl;
+                  group_impl->return_group = callee_group;
+               }
+            }
+            stmt = stmt->next;
+         }
+      }
+      func = impl->next_nested;
+   }
+}
+
+static struct call* get_tail_call( struct return_stmt* stmt ) {
+   if ( ! stmt->return_value || stmt->buildmsg ) {
+      return NULL;
+   }
+   struct node* node = stmt->return_value->root;
+   while ( node->type == NODE_PAREN ) {
+      node = ( ( struct paren* ) node )->inside;
+   }
+   if ( node->type != NODE_CALL ) {
+      return NULL;
+   }
+   struct call* call = ( struct call* ) node;
+   if ( call->func->type != FUNC_USER ) {
+      return NULL;
+   }
+   struct func_user* impl = call->func->impl;
+   if ( ! impl->local || call->func->return_spec == SPEC_VOID ||
+      call->func->ref ) {
+      return NULL;
+   }
+   return call;
+}
+
+static struct func* find_return_group( struct func* func ) {
+   struct func_user* impl = func->impl;
+   while ( impl->return_group ) {
+      func = impl->return_group;
+      impl = func->impl;
+   }
+   return func;
+}
+
+// Calls that return through the same return-table get different IDs. A tail
+// call returns through the table of the calling function, so it gets no ID.
 static void assign_nested_call_ids( struct codegen* codegen,
    struct func* nested_funcs ) {
-   struct func* nested_func = nested_funcs;
-   while ( nested_func ) {
-      struct func_user* nested_impl = nested_func->impl;
-      struct call* call = nested_impl->nested_calls;
-      int id = 0;
-      while ( call ) {
-         call->nested_call->id = id;
-         ++id;
-         call = call->nested_call->next;
+   struct func* group = nested_funcs;
+   while ( group ) {
+      struct func_user* group_impl = group->impl;
+      if ( ! group_impl->return_group ) {
+         int id = 0;
+         struct func* func = nested_funcs;
+         while ( func ) {
+            struct func_user* impl = func->impl;
+            if ( find_return_group( func ) == group ) {
+               struct call* call = impl->nested_calls;
+               while ( call ) {
+                  if ( ! call->nested_call->tail ) {
+                     call->nested_call->id = id;
+                     ++id;
+                  }
+                  call = call->nested_call->next;
+               }
+            }
+            func = impl->next_nested;
+         }
+         // With a single place to return to, there is nothing to look up.
+         set_direct_return( nested_funcs, group, ( id == 1 &&
+            codegen->task->options->optimize >= OPTIMIZE_BASIC ) );
+      }
+      group = group_impl->next_nested;
+   }
+}
+
+static void set_direct_return( struct func* nested_funcs, struct func* group,
+   bool direct_return ) {
+   struct func* func = nested_funcs;
+   while ( func ) {
+      struct func_user* impl = func->impl;
+      if ( find_return_group( func ) == group ) {
+         impl->direct_return = direct_return;
       }
-      nested_func = nested_impl->next_nested;
+      func = impl->next_nested;
    }
 }
 
@@ -614,7 +807,7 @@ static void write_nested_funcs( struct codegen* codegen,
    // Insert address of function into each call.
    func = writing->nested_funcs;
    while ( func ) {
-      patch_nestedfunc_addresses( codegen, func );
+      patch_nestedfunc_addresses( codegen, writing, func );
       struct func_user* impl = func->impl;
       func = impl->next_nested;
    }
@@ -641,6 +834,12 @@ static void write_one_nestedfunc( struct codegen* codegen,
    // -----------------------------------------------------------------------
    c_write_block( codegen, impl->body );
    impl->size = record.size;
+   bool* saved = mem_alloc( sizeof( *saved ) * ( impl->size + 1 ) );
+   int saved_size = 0;
+   if ( impl->recursive == RECURSIVE_POSSIBLY ) {
+      saved_size = find_saved_vars( codegen, writing, func,
+         &prologue_point->node, start_index, saved );
+   }
    // Prologue (part #2):
    // -----------------------------------------------------------------------
    c_seek_node( codegen, &prologue_point->node );
@@ -656,7 +855,9 @@ static void write_one_nestedfunc( struct codegen* codegen,
       // restored at epilogue.
       i = 0;
       while ( i < impl->size ) {
-         c_pcd( codegen, PCD_PUSHSCRIPTVAR, start_index + i );
+         if ( saved[ i ] ) {
+            c_pcd( codegen, PCD_PUSHSCRIPTVAR, start_index + i );
+         }
          ++i;
       }
    }
@@ -680,34 +881,45 @@ static void write_one_nestedfunc( struct codegen* codegen,
    int return_var = writing->temps_start;
    if ( func->return_spec != SPEC_VOID ) {
       if ( impl->recursive == RECURSIVE_POSSIBLY ) {
-         if ( impl->size > 0 ) {
+         if ( saved_size > 0 ) {
             c_pcd( codegen, PCD_ASSIGNSCRIPTVAR, return_var );
          }
       }
    }
    // Restore previous values of variables.
    if ( impl->recursive == RECURSIVE_POSSIBLY ) {
-      int index = start_index + impl->size - 1;
-      int i = 0;
-      while ( i < impl->size ) {
-         c_pcd( codegen, PCD_ASSIGNSCRIPTVAR, index );
-         --index;
-         ++i;
+      int i = impl->size - 1;
+      while ( i >= 0 ) {
+         if ( saved[ i ] ) {
+            c_pcd( codegen, PCD_ASSIGNSCRIPTVAR, start_index + i );
+         }
+         --i;
       }
    }
+   mem_free( saved );
    // Push return-value onto the stack.
    if ( func->return_spec != SPEC_VOID || func->ref ) {
       if ( impl->recursive == RECURSIVE_POSSIBLY ) {
-         if ( impl->size > 0 ) {
+         if ( saved_size > 0 ) {
             c_pcd( codegen, PCD_PUSHSCRIPTVAR, return_var );
          }
       }
-      c_pcd( codegen, PCD_SWAP );
+      if ( ! impl->direct_return ) {
+         c_pcd( codegen, PCD_SWAP );
+      }
+   }
+   // Add return-table, or a jump back to the only caller.
+   if ( impl->direct_return ) {
+      struct c_jump* return_jump = c_create_jump( codegen, PCD_GOTO );
+      c_append_node( codegen, &return_jump->node );
+      impl->return_jump = return_jump;
+   }
+   else {
+      struct c_sortedcasejump* return_table =
+         c_create_sortedcasejump( codegen );
+      c_append_node( codegen, &return_table->node );
+      impl->return_table = return_table;
    }
-   // Add return-table.
-   struct c_sortedcasejump* return_table = c_create_sortedcasejump( codegen );
-   c_append_node( codegen, &return_table->node );
-   impl->return_table = return_table;
    // Patch address of return-statements.
    struct return_stmt* stmt = impl->returns;
    while ( stmt ) {
@@ -718,8 +930,54 @@ static void write_one_nestedfunc( struct codegen* codegen,
    codegen->func = NULL;
 }
 
+// A recursive function saves the variables that a call coming back into the
+// function can overwrite. With optimization, only the variables live when one
+// of its calls to a recursive function returns are saved. Returns the number
+// of saved variables.
+static int find_saved_vars( struct codegen* codegen,
+   struct nestedfunc_writing* writing, struct func* func,
+   struct c_node* body, int start_index, bool* saved ) {
+   struct func_user* impl = func->impl;
+   bool all = true;
+   if ( codegen->task->options->optimize >= OPTIMIZE_BASIC ) {
+      struct list points;
+      list_init( &points );
+      struct func* callee = writing->nested_funcs;
+      while ( callee ) {
+         struct func_user* callee_impl = callee->impl;
+         if ( callee_impl->recursive == RECURSIVE_POSSIBLY ) {
+            struct call* call = callee_impl->nested_calls;
+            while ( call ) {
+               if ( call->nested_call->caller == func &&
+                  call->nested_call->return_point ) {
+                  list_append( &points, call->nested_call->return_point );
+               }
+               call = call->nested_call->next;
+            }
+         }
+         callee = callee_impl->next_nested;
+      }
+      memset( saved, 0, sizeof( *saved ) * impl->size );
+      all = ! c_find_live_slots( body, start_index, impl->size, &points,
+         saved );
+      list_deinit( &points );
+   }
+   int saved_size = 0;
+   int i = 0;
+   while ( i < impl->size ) {
+      if ( all ) {
+         saved[ i ] = true;
+      }
+      if ( saved[ i ] ) {
+         ++saved_size;
+      }
+      ++i;
+   }
+   return saved_size;
+}
+
 static void patch_nestedfunc_addresses( struct codegen* codegen,
-   struct func* func ) {
+   struct nestedfunc_writing* writing, struct func* func ) {
    struct func_user* impl = func->impl;
    // Correct calls to function.
    struct call* call = impl->nested_calls;
@@ -727,12 +985,28 @@ static void patch_nestedfunc_addresses( struct codegen* codegen,
       call->nested_call->prologue_jump->point = impl->prologue_point;
       call = call->nested_call->next;
    }
-   // Populate return-table.
-   call = impl->nested_calls;
-   while ( call ) {
-      struct c_casejump* entry = c_create_casejump( codegen,
-         call->nested_call->id, call->nested_call->return_point );
-      c_append_casejump( impl->return_table, entry );
-      call = call->nested_call->next;
+   // Populate return-table. The function returns to the calls made to any
+   // function of its group, in the order the IDs were assigned.
+   struct func* group = find_return_group( func );
+   struct func* member = writing->nested_funcs;
+   while ( member ) {
+      struct func_user* member_impl = member->impl;
+      if ( find_return_group( member ) == group ) {
+         call = member_impl->nested_calls;
+         while ( call ) {
+            if ( ! call->nested_call->tail ) {
+               if ( impl->direct_return ) {
+                  impl->return_jump->point = call->nested_call->return_point;
+               }
+               else {
+                  struct c_casejump* entry = c_create_casejump( codegen,
+                     call->nested_call->id, call->nested_call->return_point );
+                  c_append_casejump( impl->return_table, entry );
+               }
+            }
+            call = call->nested_call->next;
+         }
+      }
+      member = member_impl->next_nested;
    }
 }
@@ -185,6 +185,9 @@ static void call_local_user_func( struct codegen* codegen,
    struct result* result, struct call* call );
 static void call_user_func( struct codegen* codegen, struct result* result,
    struct call* call );
+static bool inline_call( struct codegen* codegen, struct call* call );
+static void call_inline_user_func( struct codegen* codegen,
+   struct result* result, struct call* call );
 static void write_call_args( struct codegen* codegen, struct call* call );
 static void push_arg( struct codegen* codegen, struct param* param,
    struct expr* expr );
@@ -226,6 +229,8 @@ static void visit_enumerator( struct codegen* codegen,
    struct result* result, struct enumerator* enumerator );
 static void visit_var( struct codegen* codegen, struct result* result,
    struct var* var );
+static void push_immutable_value( struct codegen* codegen, struct var* var,
+   int offset );
 static void visit_shary_ref_var( struct codegen* codegen,
    struct result* result, struct var* var );
 static void visit_ref_var( struct codegen* codegen, struct result* result,
@@ -1371,6 +1376,14 @@ static void visit_suffix( struct codegen* codegen, struct result* result,
 
 static void visit_subscript( struct codegen* codegen, struct result* result,
    struct subscript* subscript ) {
+   // Constant element of an array that is never written.
+   if ( subscript->var && subscript->var->immutable ) {
+      if ( result->push ) {
+         push_immutable_value( codegen, subscript->var, subscript->offset );
+         result->status = R_VALUE;
+      }
+      return;
+   }
    struct result lside;
    init_result( &lside, true );
    visit_suffix( codegen, &lside, subscript->lside );
@@ -1803,10 +1816,21 @@ static void visit_ded_call( struct codegen* codegen, struct result* result,
 
 static void visit_user_call( struct codegen* codegen, struct result* result,
    struct call* call ) {
+   // The result of the call is known at compile time.
+   if ( call->folded ) {
+      if ( result->push ) {
+         c_pcd( codegen, PCD_PUSHNUMBER, call->value );
+         result->status = R_VALUE;
+      }
+      return;
+   }
    struct func_user* impl = call->func->impl;
    if ( impl->local ) {
       call_local_user_func( codegen, result, call );
    }
+   else if ( inline_call( codegen, call ) ) {
+      call_inline_user_func( codegen, result, call );
+   }
    else {
       call_user_func( codegen, result, call );
    }
@@ -1814,15 +1838,22 @@ static void visit_user_call( struct codegen* codegen, struct result* result,
 
 static void call_local_user_func( struct codegen* codegen,
    struct result* result, struct call* call ) {
-   // Push ID of entry to identify return address.
-   c_pcd( codegen, PCD_PUSHNUMBER, call->nested_call->id );
+   struct nested_call* nested_call = call->nested_call;
+   struct func_user* impl = call->func->impl;
+   // Push ID of entry to identify return address. A tail call keeps the ID
+   // pushed by the caller of the current function.
+   if ( ! ( impl->direct_return || nested_call->tail ) ) {
+      c_pcd( codegen, PCD_PUSHNUMBER, nested_call->id );
+   }
    write_call_args( codegen, call );
    struct c_jump* prologue_jump = c_create_jump( codegen, PCD_GOTO );
    c_append_node( codegen, &prologue_jump->node );
-   call->nested_call->prologue_jump = prologue_jump;
-   struct c_point* return_point = c_create_point( codegen );
-   c_append_node( codegen, &return_point->node );
-   call->nested_call->return_point = return_point;
+   nested_call->prologue_jump = prologue_jump;
+   if ( ! nested_call->tail ) {
+      struct c_point* return_point = c_create_point( codegen );
+      c_append_node( codegen, &return_point->node );
+      nested_call->return_point = return_point;
+   }
    if ( call->func->return_spec != SPEC_VOID ) {
       set_user_func_call_result( codegen, call, result );
    }
@@ -1841,6 +1872,27 @@ static void call_user_func( struct codegen* codegen, struct result* result,
    }
 }
 
+static bool inline_call( struct codegen* codegen, struct call* call ) {
+   return ( codegen->task->options->optimize >= OPTIMIZE_INLINE &&
+      codegen->func && c_is_inlinable_func( call->func ) &&
+      c_fits_inline_budget( codegen, call->func ) );
+}
+
+static void call_inline_user_func( struct codegen* codegen,
+   struct result* result, struct call* call ) {
+   write_call_args( codegen, call );
+   c_write_inline_func( codegen, call->func );
+   if ( call->func->return_spec != SPEC_VOID ) {
+      if ( result->push ) {
+         set_user_func_call_result( codegen, call, result );
+      }
+      else {
+         c_pcd( codegen, PCD_DROP );
+      }
+   }
+   ++codegen->optimize_stats.inlined_calls;
+}
+
 static void write_call_args( struct codegen* codegen, struct call* call ) {
    struct param* param = call->func->params;
    // Push arguments.
@@ -2304,6 +2356,9 @@ static void visit_boolean( struct codegen* codegen, struct result* result,
 static void visit_name_usage( struct codegen* codegen, struct result* result,
    struct name_usage* usage ) {
    visit_general_name_usage( codegen, result, usage->object );
+   if ( usage->non_null ) {
+      result->safe = true;
+   }
 }
 
 static void visit_qualified_name_usage( struct codegen* codegen,
@@ -2418,6 +2473,13 @@ static void visit_var( struct codegen* codegen, struct result* result,
       }
       result->direct = true;
    }
+   // Primitive variable that is never written.
+   else if ( var->immutable ) {
+      if ( result->push ) {
+         push_immutable_value( codegen, var, 0 );
+         result->status = R_VALUE;
+      }
+   }
    // Primitive variable.
    else {
       if ( var->in_shared_array ) {
@@ -2446,6 +2508,21 @@ static void visit_var( struct codegen* codegen, struct result* result,
    }
 }
 
+// Pushes the initial value found at the offset of the variable.
+static void push_immutable_value( struct codegen* codegen, struct var* var,
+   int offset ) {
+   struct value* value = t_find_value( var, offset );
+   if ( ! value ) {
+      c_pcd( codegen, PCD_PUSHNUMBER, 0 );
+   }
+   else if ( value->type == VALUE_STRING ) {
+      c_push_string( codegen, value->more.string.string );
+   }
+   else {
+      c_pcd( codegen, PCD_PUSHNUMBER, value->expr->value );
+   }
+}
+
 static void visit_shary_ref_var( struct codegen* codegen,
    struct result* result, struct var* var ) {
    c_pcd( codegen, PCD_PUSHNUMBER, var->index );
@@ -0,0 +1,362 @@
+#include "phase.h"
+
+// The body of a small user function can be written in place of a call to the
+// function. The size of a function is estimated from its syntax tree: about
+// one unit per statement, operator, and operand.
+enum { MAX_INLINE_COST = 12 };
+// Size of a call, not counting its arguments. A body that is not larger than
+// the call, counting the stores into its parameters, is always inlined.
+enum { CALL_COST = 2 };
+// Larger bodies are inlined only while the function they are written into
+// grows by at most this much in total. The body of an inlined function is
+// still written, so each such call makes the object file larger.
+enum { MAX_INLINE_GROWTH = 12 };
+
+struct inline_test {
+   int cost;
+};
+
+static bool has_scalar_locals( struct func_user* impl );
+static bool test_block( struct inline_test* test, struct block* block );
+static bool test_stmt( struct inline_test* test, struct node* node );
+static bool test_switch( struct inline_test* test,
+   struct switch_stmt* stmt );
+static bool test_for( struct inline_test* test, struct for_stmt* stmt );
+static bool test_cond( struct inline_test* test, struct cond* cond );
+static bool test_local_var( struct inline_test* test, struct var* var );
+static bool test_expr_list( struct inline_test* test, struct list* list );
+static bool test_expr( struct inline_test* test, struct expr* expr );
+static bool test_node( struct inline_test* test, struct node* node );
+static bool test_call( struct inline_test* test, struct call* call );
+static bool test_format_items( struct inline_test* test,
+   struct format_item* item );
+
+// A function can be inlined when it is small, is defined in the library
+// being compiled, has no nested functions, has no local arrays or
+// structures, and does not reach itself through calls that would be inlined.
+// The body of the function is still written, so calls made through function
+// references and calls from other libraries keep working. The result is
+// cached in the function. A function being tested is marked, so a call back
+// into it is seen as recursion. Only the function that is called back is
+// then left out; the functions in between are judged on their own, because
+// the call that closes the cycle is never inlined.
+bool c_is_inlinable_func( struct func* func ) {
+   if ( func->type != FUNC_USER ) {
+      return false;
+   }
+   struct func_user* impl = func->impl;
+   switch ( impl->inlinable ) {
+   case INLINABLE_UNDETERMINED:
+      break;
+   case INLINABLE_YES:
+      return true;
+   default:
+      return false;
+   }
+   impl->inlinable = INLINABLE_TESTING;
+   struct inline_test test;
+   test.cost = 0;
+   bool inlinable = ( ! impl->nested && ! impl->local &&
+      ! impl->nested_funcs && impl->body && ! func->imported && ! func->ref &&
+      has_scalar_locals( impl ) && test_block( &test, impl->body ) &&
+      test.cost <= MAX_INLINE_COST &&
+      impl->inlinable != INLINABLE_RECURSIVE );
+   impl->inlinable = inlinable ? INLINABLE_YES : INLINABLE_NO;
+   impl->inline_cost = test.cost;
+   return inlinable;
+}
+
+// Decides whether a call to an inlinable function is inlined into the
+// function being written, and charges the growth to it.
+bool c_fits_inline_budget( struct codegen* codegen, struct func* func ) {
+   struct func_user* impl = func->impl;
+   int growth = impl->inline_cost + c_total_param_size( func ) - CALL_COST;
+   if ( growth > 0 ) {
+      if ( codegen->func->inline_growth + growth > MAX_INLINE_GROWTH ) {
+         return false;
+      }
+      codegen->func->inline_growth += growth;
+   }
+   return true;
+}
+
+static bool has_scalar_locals( struct func_user* impl ) {
+   struct list_iter i;
+   list_iterate( &impl->vars, &i );
+   while ( ! list_end( &i ) ) {
+      struct var* var = list_data( &i );
+      if ( ! ( var->desc == DESC_PRIMITIVEVAR ||
+         var->desc == DESC_REFVAR ) ) {
+         return false;
+      }
+      list_next( &i );
+   }
+   return true;
+}
+
+static bool test_block( struct inline_test* test, struct block* block ) {
+   struct list_iter i;
+   list_iterate( &block->stmts, &i );
+   while ( ! list_end( &i ) ) {
+      if ( ! test_stmt( test, list_data( &i ) ) ) {
+         return false;
+      }
+      list_next( &i );
+   }
+   return true;
+}
+
+static bool test_stmt( struct inline_test* test, struct node* node ) {
+   ++test->cost;
+   switch ( node->type ) {
+   case NODE_BLOCK:
+      return test_block( test, ( struct block* ) node );
+   case NODE_IF: {
+         struct if_stmt* stmt = ( struct if_stmt* ) node;
+         return ( ! stmt->cond.var && test_expr( test, stmt->cond.expr ) &&
+            test_stmt( test, stmt->body ) && ( ! stmt->else_body ||
+            test_stmt( test, stmt->else_body ) ) );
+      }
+   case NODE_SWITCH:
+      return test_switch( test, ( struct switch_stmt* ) node );
+   case NODE_WHILE: {
+         struct while_stmt* stmt = ( struct while_stmt* ) node;
+         return ( test_cond( test, &stmt->cond ) &&
+            test_block( test, stmt->body ) );
+      }
+   case NODE_DO: {
+         struct do_stmt* stmt = ( struct do_stmt* ) node;
+         return ( test_expr( test, stmt->cond ) &&
+            test_block( test, stmt->body ) );
+      }
+   case NODE_FOR:
+      return test_for( test, ( struct for_stmt* ) node );
+   case NODE_JUMP:
+      return true;
+   case NODE_RETURN: {
+         struct return_stmt* stmt = ( struct return_stmt* ) node;
+         return ( ! stmt->buildmsg && ( ! stmt->return_value ||
+            test_expr( test, stmt->return_value ) ) );
+      }
+   case NODE_EXPR_STMT:
+      return test_expr_list( test,
+         &( ( struct expr_stmt* ) node )->expr_list );
+   case NODE_VAR:
+      return test_local_var( test, ( struct var* ) node );
+   case NODE_ASSERT: {
+         struct assert* assert = ( struct assert* ) node;
+         return ( assert->is_static || ( test_expr( test, assert->cond ) &&
+            ( ! assert->message || test_expr( test, assert->message ) ) ) );
+      }
+   case NODE_CONSTANT:
+   case NODE_ENUMERATION:
+   case NODE_TYPE_ALIAS:
+   case NODE_STRUCTURE:
+   case NODE_USING:
+      --test->cost;
+      return true;
+   default:
+      return false;
+   }
+}
+
+static bool test_switch( struct inline_test* test,
+   struct switch_stmt* stmt ) {
+   if ( stmt->cond.var || ! test_expr( test, stmt->cond.expr ) ) {
+      return false;
+   }
+   test->cost += stmt->num_cases;
+   if ( stmt->body->type != NODE_BLOCK ) {
+      return test_stmt( test, stmt->body );
+   }
+   struct block* body = ( struct block* ) stmt->body;
+   struct list_iter i;
+   list_iterate( &body->stmts, &i );
+   while ( ! list_end( &i ) ) {
+      struct node* node = list_data( &i );
+      if ( ! ( node->type == NODE_CASE || node->type == NODE_CASE_DEFAULT ||
+         test_stmt( test, node ) ) ) {
+         return false;
+      }
+      list_next( &i );
+   }
+   return true;
+}
+
+static bool test_for( struct inline_test* test, struct for_stmt* stmt ) {
+   struct list_iter i;
+   list_iterate( &stmt->init, &i );
+   while ( ! list_end( &i ) ) {
+      struct node* init = list_data( &i );
+      if ( ! ( init->type == NODE_VAR ?
+         test_local_var( test, ( struct var* ) init ) :
+         test_expr( test, ( struct expr* ) init ) ) ) {
+         return false;
+      }
+      list_next( &i );
+   }
+   return ( test_expr_list( test, &stmt->post ) &&
+      ( ! stmt->cond.u.node || test_cond( test, &stmt->cond ) ) &&
+      test_stmt( test, stmt->body ) );
+}
+
+static bool test_cond( struct inline_test* test, struct cond* cond ) {
+   return ( cond->u.node->type == NODE_EXPR &&
+      test_expr( test, cond->u.expr ) );
+}
+
+static bool test_local_var( struct inline_test* test, struct var* var ) {
+   if ( var->storage != STORAGE_LOCAL ) {
+      return true;
+   }
+   // The variable is set to zero at the start of the inlined body.
+   if ( ! var->initial ) {
+      ++test->cost;
+      return true;
+   }
+   return ( ! var->initial->multi && var->value->type == VALUE_EXPR &&
+      test_expr( test, var->value->expr ) );
+}
+
+static bool test_expr_list( struct inline_test* test, struct list* list ) {
+   struct list_iter i;
+   list_iterate( list, &i );
+   while ( ! list_end( &i ) ) {
+      if ( ! test_expr( test, list_data( &i ) ) ) {
+         return false;
+      }
+      list_next( &i );
+   }
+   return true;
+}
+
+static bool test_expr( struct inline_test* test, struct expr* expr ) {
+   return test_node( test, expr->root );
+}
+
+static bool test_node( struct inline_test* test, struct node* node ) {
+   ++test->cost;
+   switch ( node->type ) {
+   case NODE_LITERAL:
+   case NODE_FIXED_LITERAL:
+   case NODE_BOOLEAN:
+   case NODE_INDEXED_STRING_USAGE:
+   case NODE_NAME_USAGE:
+   case NODE_QUALIFIEDNAMEUSAGE:
+   case NODE_MAGICID:
+   case NODE_NULL:
+      return true;
+   case NODE_EXPR:
+      --test->cost;
+      return test_expr( test, ( struct expr* ) node );
+   case NODE_PAREN:
+      --test->cost;
+      return test_node( test, ( ( struct paren* ) node )->inside );
+   case NODE_UNARY:
+      return test_node( test, ( ( struct unary* ) node )->operand );
+   case NODE_BINARY: {
+         struct binary* binary = ( struct binary* ) node;
+         return ( test_node( test, binary->lside ) &&
+            test_node( test, binary->rside ) );
+      }
+   case NODE_LOGICAL: {
+         struct logical* logical = ( struct logical* ) node;
+         return ( test_node( test, logical->lside ) &&
+            test_node( test, logical->rside ) );
+      }
+   case NODE_CONDITIONAL: {
+         struct conditional* cond = ( struct conditional* ) node;
+         return ( test_node( test, cond->left ) &&
+            ( ! cond->middle || test_node( test, cond->middle ) ) &&
+            test_node( test, cond->right ) );
+      }
+   case NODE_ASSIGN: {
+         struct assign* assign = ( struct assign* ) node;
+         return ( test_node( test, assign->lside ) &&
+            test_node( test, assign->rside ) );
+      }
+   case NODE_INC:
+      return test_node( test, ( ( struct inc* ) node )->operand );
+   case NODE_CAST:
+      return test_node( test, ( ( struct cast* ) node )->operand );
+   case NODE_CONVERSION:
+      return test_expr( test, ( ( struct conversion* ) node )->expr );
+   case NODE_SURE:
+      return test_node( test, ( ( struct sure* ) node )->operand );
+   case NODE_SUBSCRIPT: {
+         struct subscript* subscript = ( struct subscript* ) node;
+         return ( test_node( test, subscript->lside ) &&
+            test_expr( test, subscript->index ) );
+      }
+   case NODE_ACCESS:
+      return test_node( test, ( ( struct access* ) node )->lside );
+   case NODE_CALL:
+      return test_call( test, ( struct call* ) node );
+   default:
+      return false;
+   }
+}
+
+static bool test_call( struct inline_test* test, struct call* call ) {
+   if ( call->folded ) {
+      return true;
+   }
+   switch ( call->func->type ) {
+   case FUNC_ASPEC:
+   case FUNC_EXT:
+   case FUNC_DED:
+   case FUNC_INTERNAL:
+      break;
+   case FUNC_FORMAT:
+      if ( ! test_format_items( test, call->format_item ) ) {
+         return false;
+      }
+      break;
+   // The callee is tested to find recursion. The growth from inlining it
+   // is charged at the call site.
+   case FUNC_USER: {
+         struct func_user* impl = call->func->impl;
+         if ( impl->inlinable == INLINABLE_TESTING ) {
+            impl->inlinable = INLINABLE_RECURSIVE;
+         }
+         else {
+            c_is_inlinable_func( call->func );
+         }
+      }
+      break;
+   case FUNC_SAMPLE:
+      if ( ! test_node( test, call->operand ) ) {
+         return false;
+      }
+      break;
+   default:
+      return false;
+   }
+   return test_expr_list( test, &call->args );
+}
+
+static bool test_format_items( struct inline_test* test,
+   struct format_item* item ) {
+   while ( item ) {
+      switch ( item->cast ) {
+      case FCAST_BUILDMSG:
+         return false;
+      case FCAST_ARRAY: {
+            struct format_item_array* extra = item->extra;
+            if ( extra && ( ( extra->offset &&
+               ! test_expr( test, extra->offset ) ) || ( extra->length &&
+               ! test_expr( test, extra->length ) ) ) ) {
+               return false;
+            }
+         }
+         break;
+      default:
+         break;
+      }
+      if ( ! test_expr( test, item->value ) ) {
+         return false;
+      }
+      item = item->next;
+   }
+   return true;
+}
@@ -5,11 +5,15 @@
 #include "linear.h"
 
 static void* alloc_node( struct codegen* codegen, int type );
-static void free_node( struct codegen* codegen, struct c_node* node );
+static void* alloc_space( struct codegen* codegen, size_t size );
+static void reset_chunks( struct codegen* codegen );
 static void init_node( struct c_node* node, int type );
 static void create_pcode( struct codegen* codegen, int code, bool optimize );
 static void add_arg( struct codegen* codegen,
    struct c_point* point, int value );
+static void grow_args( struct codegen* codegen, struct c_pcode* pcode );
+static void add_patch( struct codegen* codegen, struct c_node* node,
+   int count );
 static void add_pushbytes( struct codegen* codegen, va_list* args );
 static void add_casegotosorted( struct codegen* codegen, va_list* args );
 static void add_fixed( struct codegen* codegen, int code, va_list* args );
@@ -22,20 +26,54 @@ static void write_sortedcasejump( struct codegen* codegen,
    struct c_sortedcasejump* sorted_jump );
 
 static void* alloc_node( struct codegen* codegen, int type ) {
-   if ( codegen->free_nodes[ type ] ) {
-      struct c_node* node = codegen->free_nodes[ type ];
-      codegen->free_nodes[ type ] = node->next;
-      return node;
+   static size_t sizes[] = {
+      sizeof( struct c_point ),
+      sizeof( struct c_jump ),
+      sizeof( struct c_casejump ),
+      sizeof( struct c_sortedcasejump ),
+      sizeof( struct c_pcode ),
+   };
+   return alloc_space( codegen, sizes[ type ] );
+}
+
+static void* alloc_space( struct codegen* codegen, size_t size ) {
+   enum { CHUNK_SIZE = 32768 };
+   size = ( size + sizeof( long long ) - 1 ) & ~( sizeof( long long ) - 1 );
+   struct c_node_chunk* chunk = codegen->node_chunk;
+   while ( ! chunk || chunk->used + size > chunk->size ) {
+      if ( chunk && chunk->next ) {
+         chunk = chunk->next;
+         chunk->used = 0;
+      }
+      else {
+         size_t chunk_size = CHUNK_SIZE;
+         if ( chunk_size < size ) {
+            chunk_size = size;
+         }
+         struct c_node_chunk* new_chunk = mem_alloc( sizeof( *new_chunk ) +
+            chunk_size );
+         new_chunk->next = NULL;
+         new_chunk->size = chunk_size;
+         new_chunk->used = 0;
+         if ( chunk ) {
+            chunk->next = new_chunk;
+         }
+         else {
+            codegen->node_chunks = new_chunk;
+         }
+         chunk = new_chunk;
+      }
    }
-   else {
-      static size_t sizes[] = {
-         sizeof( struct c_point ),
-         sizeof( struct c_jump ),
-         sizeof( struct c_casejump ),
-         sizeof( struct c_sortedcasejump ),
-         sizeof( struct c_pcode ),
-      };
-      return mem_alloc( sizes[ type ] );
+   codegen->node_chunk = chunk;
+   void* space = ( char* ) chunk->data + chunk->used;
+   chunk->used += size;
+   return space;
+}
+
+static void reset_chunks( struct codegen* codegen ) {
+   codegen->node_chunk = codegen->node_chunks;
+   if ( codegen->node_chunk ) {
+      codegen->node_chunk->used = 0;
    }
 }
 
@@ -58,21 +96,6 @@ void c_append_node( struct codegen* codegen, struct c_node* node ) {
    codegen->node = node;
 }
 
-static void free_node( struct codegen* codegen, struct c_node* node ) {
-   node->next = codegen->free_nodes[ node->type ];
-   codegen->free_nodes[ node->type ] = node;
-   if ( node->type == C_NODE_PCODE ) {
-      struct c_pcode* pcode = ( struct c_pcode* ) node;
-      struct c_pcode_arg* arg = pcode->args;
-      while ( arg ) {
-         struct c_pcode_arg* next_arg = arg->next;
-         arg->next = codegen->free_pcode_args;
-         codegen->free_pcode_args = arg;
-         arg = next_arg;
-      }
-   }
-}
-
 static void init_node( struct c_node* node, int type ) {
    node->next = NULL;
    node->type = type;
@@ -82,6 +105,7 @@ struct c_point* c_create_point( struct codegen* codegen ) {
    struct c_point* point = alloc_node( codegen, C_NODE_POINT );
    init_node( &point->node, C_NODE_POINT );
    point->obj_pos = 0;
+   point->used = false;
    return point;
 }
 
@@ -141,13 +165,15 @@ static void create_pcode( struct codegen* codegen, int code, bool optimize ) {
    struct c_pcode* pcode = alloc_node( codegen, C_NODE_PCODE );
    init_node( &pcode->node, C_NODE_PCODE );
    pcode->code = code;
-   pcode->args = NULL;
+   pcode->overflow_args = NULL;
+   pcode->points = NULL;
+   pcode->argc = 0;
+   pcode->capacity = C_PCODE_INLINE_ARGS;
    pcode->obj_pos = 0;
    pcode->optimize = optimize;
    pcode->patch = false;
    c_append_node( codegen, &pcode->node );
    codegen->pcode = pcode;
-   codegen->pcodearg_tail = NULL;
 }
 
 void c_arg( struct codegen* codegen, int value ) {
@@ -161,23 +187,45 @@ void c_point_arg( struct codegen* codegen, struct c_point* point ) {
 
 static void add_arg( struct codegen* codegen, struct c_point* point,
    int value ) {
-   struct c_pcode_arg* arg = codegen->free_pcode_args;
-   if ( arg ) {
-      codegen->free_pcode_args = arg->next;
+   struct c_pcode* pcode = codegen->pcode;
+   if ( pcode->argc == pcode->capacity ) {
+      grow_args( codegen, pcode );
    }
-   else {
-      arg = mem_alloc( sizeof( *arg ) );
+   int* args = pcode->overflow_args ? pcode->overflow_args : pcode->args;
+   args[ pcode->argc ] = value;
+   if ( point && ! pcode->points ) {
+      pcode->points = alloc_space( codegen,
+         sizeof( *pcode->points ) * pcode->capacity );
+      for ( int i = 0; i < pcode->capacity; ++i ) {
+         pcode->points[ i ] = NULL;
+      }
    }
-   arg->next = NULL;
-   arg->point = point;
-   arg->value = value;
-   if ( codegen->pcodearg_tail ) {
-      codegen->pcodearg_tail->next = arg;
+   if ( pcode->points ) {
+      pcode->points[ pcode->argc ] = point;
    }
-   else {
-      codegen->pcode->args = arg;
+   ++pcode->argc;
+}
+
+// Moves the arguments into a larger block of the arena. The old block is
+// reclaimed when the arena is reset.
+static void grow_args( struct codegen* codegen, struct c_pcode* pcode ) {
+   int capacity = pcode->capacity * 2;
+   int* args = alloc_space( codegen, sizeof( *args ) * capacity );
+   const int* old_args = pcode->overflow_args ? pcode->overflow_args :
+      pcode->args;
+   for ( int i = 0; i < pcode->argc; ++i ) {
+      args[ i ] = old_args[ i ];
    }
-   codegen->pcodearg_tail = arg;
+   pcode->overflow_args = args;
+   if ( pcode->points ) {
+      struct c_point** points = alloc_space( codegen,
+         sizeof( *points ) * capacity );
+      for ( int i = 0; i < capacity; ++i ) {
+         points[ i ] = i < pcode->argc ? pcode->points[ i ] : NULL;
+      }
+      pcode->points = points;
+   }
+   pcode->capacity = capacity;
 }
 
 void c_pcd( struct codegen* codegen, int code, ... ) {
@@ -231,39 +279,53 @@ static void add_fixed( struct codegen* codegen, int code, va_list* args ) {
 // ==========================================================================
 
 void c_flush_pcode( struct codegen* codegen ) {
+   if ( codegen->task->options->optimize >= OPTIMIZE_BASIC ) {
+      c_optimize_pcode( codegen );
+   }
+   // Write the nodes, remembering the ones that refer to a point.
+   int count = 0;
    struct c_node* node = codegen->node_head;
    while ( node ) {
       write_node( codegen, node );
-      node = node->next;
-   }
-   // Patch address of jumps and delete nodes.
-   node = codegen->node_head;
-   while ( node ) {
       switch ( node->type ) {
-         struct c_pcode* pcode;
       case C_NODE_JUMP:
       case C_NODE_CASEJUMP:
       case C_NODE_SORTEDCASEJUMP:
-         write_node( codegen, node );
+         add_patch( codegen, node, count );
+         ++count;
          break;
       case C_NODE_PCODE:
-         pcode = ( struct c_pcode* ) node;
-         if ( pcode->patch ) {
-            write_pcode( codegen, pcode );
+         if ( ( ( struct c_pcode* ) node )->patch ) {
+            add_patch( codegen, node, count );
+            ++count;
          }
          break;
       default:
          break;
-       }
-      // Free node.
-      struct c_node* next_node = node->next; 
-      free_node( codegen, node );
-      node = next_node;
+      }
+      node = node->next;
+   }
+   // Patch address of jumps.
+   for ( int i = 0; i < count; ++i ) {
+      write_node( codegen, codegen->patch_nodes[ i ] );
    }
    c_seek_end( codegen );
    codegen->node = NULL;
    codegen->node_head = NULL;
    codegen->node_tail = NULL;
+   codegen->pcode = NULL;
+   reset_chunks( codegen );
+}
+
+static void add_patch( struct codegen* codegen, struct c_node* node,
+   int count ) {
+   if ( count == codegen->patch_capacity ) {
+      codegen->patch_capacity = codegen->patch_capacity ?
+         codegen->patch_capacity * 2 : 64;
+      codegen->patch_nodes = mem_realloc( codegen->patch_nodes,
+         sizeof( *codegen->patch_nodes ) * codegen->patch_capacity );
+   }
+   codegen->patch_nodes[ count ] = node;
 }
 
 static void write_node( struct codegen* codegen, struct c_node* node ) {
@@ -302,21 +364,19 @@ static void write_pcode( struct codegen* codegen, struct c_pcode* pcode ) {
          pcode->obj_pos = c_tell( codegen );
       }
    }
+   const int* args = pcode->overflow_args ? pcode->overflow_args :
+      pcode->args;
    if ( pcode->optimize ) {
       c_add_opc( codegen, pcode->code );
-      struct c_pcode_arg* arg = pcode->args;
-      while ( arg ) {
-         c_add_arg( codegen, arg->value );
-         arg = arg->next;
+      for ( int i = 0; i < pcode->argc; ++i ) {
+         c_add_arg( codegen, args[ i ] );
       }
    }
    else {
       c_write_opc( codegen, pcode->code );
-      struct c_pcode_arg* arg = pcode->args;
-      while ( arg ) {
-         c_write_arg( codegen, arg->point ?
-            arg->point->obj_pos : arg->value );
-         arg = arg->next;
+      for ( int i = 0; i < pcode->argc; ++i ) {
+         c_write_arg( codegen, ( pcode->points && pcode->points[ i ] ) ?
+            pcode->points[ i ]->obj_pos : args[ i ] );
       }
    }
 }
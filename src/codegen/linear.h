@@ -16,6 +16,8 @@ struct c_node {
 struct c_point {
    struct c_node node;
    int obj_pos;
+   // Set by the optimizer when some node jumps to the point.
+   bool used;
 };
 
 struct c_jump {
@@ -42,19 +44,31 @@ struct c_sortedcasejump {
    int obj_pos;
 };
 
+// Enough for every fixed-arity instruction. Only PUSHBYTES, CASEGOTOSORTED,
+// and inline assembly can spill into the arena.
+enum { C_PCODE_INLINE_ARGS = 6 };
+
 struct c_pcode {
    struct c_node node;
    int code;
-   struct c_pcode_arg* args;
+   int args[ C_PCODE_INLINE_ARGS ];
+   int* overflow_args;
+   // Parallel to the arguments. Allocated only for jumps to labels.
+   struct c_point** points;
+   int argc;
+   int capacity;
    int obj_pos;
    bool optimize;
    bool patch;
 };
 
-struct c_pcode_arg {
-   struct c_pcode_arg* next;
-   struct c_point* point;
-   int value;
+// Nodes and overflow arguments are carved out of chunks. The chunks stay
+// with the code generator and are reused by the next function.
+struct c_node_chunk {
+   struct c_node_chunk* next;
+   size_t size;
+   size_t used;
+   long long data[];
 };
 
 #endif
@@ -162,9 +162,18 @@ void c_add_opc( struct codegen* codegen, int code ) {
       case PCD_ADD:
       case PCD_SUBTRACT:
       case PCD_MULTIPLY:
+         if ( codegen->immediate_count >= 2 ) {
+            break;
+         }
+         goto direct;
       case PCD_DIVIDE:
       case PCD_MODULUS:
-         if ( codegen->immediate_count >= 2 ) {
+         // A division by zero is left for the game to report. Dividing by -1
+         // is not folded either, since the smallest integer divided by -1
+         // overflows in the compiler.
+         if ( codegen->immediate_count >= 2 &&
+            codegen->immediate_tail->value != 0 &&
+            codegen->immediate_tail->value != -1 ) {
             break;
          }
          // FALLTHROUGH
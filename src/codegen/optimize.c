@@ -0,0 +1,1108 @@
+#include <limits.h>
+#include <string.h>
+
+#include "phase.h"
+#include "pcode.h"
+#include "linear.h"
+
+struct slot_packing {
+   struct c_node** nodes;
+   unsigned int* live;
+   unsigned int* interference;
+   unsigned int* live_out;
+   int* colors;
+   int node_count;
+   int start;
+   int count;
+   int words;
+};
+
+static bool thread_jumps( struct codegen* codegen );
+static bool thread_jump( struct codegen* codegen, struct c_point** point );
+static struct c_jump* find_goto( struct c_point* point );
+static bool remove_unreachable( struct codegen* codegen );
+static void mark_used_points( struct codegen* codegen );
+static void mark_point( struct c_point* point );
+static bool is_terminator( struct c_node* node );
+static bool run_peephole( struct codegen* codegen );
+static bool rewrite( struct codegen* codegen, struct c_node** link );
+static bool rewrite_assign_push( struct codegen* codegen,
+   struct c_pcode* assign, struct c_pcode* push );
+static bool rewrite_dropped_push( struct codegen* codegen,
+   struct c_node** link, struct c_pcode* push, struct c_pcode* drop );
+static bool rewrite_swap( struct codegen* codegen, struct c_node** link,
+   struct c_pcode* pcode, struct c_pcode* next );
+static bool rewrite_negation( struct codegen* codegen, struct c_node** link,
+   struct c_pcode* pcode, struct c_node* next );
+static bool rewrite_goto( struct codegen* codegen, struct c_node** link,
+   struct c_jump* jump );
+static bool rewrite_arithmetic( struct codegen* codegen,
+   struct c_node** link, struct c_pcode* pcode, struct c_pcode* next );
+static bool rewrite_right_operand( struct codegen* codegen,
+   struct c_node** link, struct c_pcode* number, struct c_pcode* op );
+static bool rewrite_modulo_test( struct codegen* codegen,
+   struct c_pcode* number, struct c_pcode* op );
+static bool rewrite_constant_operation( struct codegen* codegen,
+   struct c_pcode* lside, struct c_pcode* rside, struct c_pcode* op );
+static bool rewrite_absorbed_operand( struct codegen* codegen,
+   struct c_pcode* push, struct c_pcode* number, struct c_pcode* op );
+static bool rewrite_left_operand( struct codegen* codegen,
+   struct c_node** link, struct c_pcode* number, struct c_pcode* push,
+   struct c_pcode* op );
+static bool fold_operation( int code, int l, int r, int* result );
+static bool is_identity( int code, int value );
+static bool is_absorbing( int code, int value, int* result );
+static bool is_commutative( int code );
+static bool is_zero_test( struct c_node* node );
+static int get_shift( int value );
+static bool is_number( struct c_pcode* pcode );
+static bool is_pure_push( struct c_pcode* pcode );
+static struct c_pcode* get_pcode( struct c_node* node );
+static bool is_plain_push( struct c_pcode* pcode );
+static int get_push_code( int assign_code );
+static void update_tail( struct codegen* codegen );
+static bool collect_nodes( struct slot_packing* packing,
+   struct c_node* head );
+static bool get_slot_access( struct slot_packing* packing,
+   struct c_node* node, int* slot, bool* use, bool* def );
+static void compute_liveness( struct slot_packing* packing );
+static void compute_live_out( struct slot_packing* packing, int i );
+static void add_live_in( struct slot_packing* packing, int i );
+static int find_point( struct slot_packing* packing, struct c_point* point );
+static void build_interference( struct slot_packing* packing );
+static void add_interference( struct slot_packing* packing, int a, int b );
+static int color_slots( struct slot_packing* packing );
+static void rename_slots( struct slot_packing* packing );
+static bool test_bit( const unsigned int* set, int bit );
+static void set_bit( unsigned int* set, int bit );
+
+void c_optimize_pcode( struct codegen* codegen ) {
+   bool changed = true;
+   while ( changed ) {
+      changed = false;
+      if ( thread_jumps( codegen ) ) {
+         changed = true;
+      }
+      if ( remove_unreachable( codegen ) ) {
+         changed = true;
+      }
+      if ( run_peephole( codegen ) ) {
+         changed = true;
+      }
+   }
+   update_tail( codegen );
+}
+
+// Makes every jump whose target is an unconditional jump go straight to the
+// final destination.
+static bool thread_jumps( struct codegen* codegen ) {
+   bool changed = false;
+   struct c_node* node = codegen->node_head;
+   while ( node ) {
+      switch ( node->type ) {
+      case C_NODE_JUMP: {
+            struct c_jump* jump = ( struct c_jump* ) node;
+            if ( thread_jump( codegen, &jump->point ) ) {
+               changed = true;
+            }
+         }
+         break;
+      case C_NODE_CASEJUMP: {
+            struct c_casejump* jump = ( struct c_casejump* ) node;
+            if ( thread_jump( codegen, &jump->point ) ) {
+               changed = true;
+            }
+         }
+         break;
+      case C_NODE_SORTEDCASEJUMP: {
+            struct c_sortedcasejump* sorted_jump =
+               ( struct c_sortedcasejump* ) node;
+            struct c_casejump* jump = sorted_jump->head;
+            while ( jump ) {
+               if ( thread_jump( codegen, &jump->point ) ) {
+                  changed = true;
+               }
+               jump = jump->next;
+            }
+         }
+         break;
+      default:
+         break;
+      }
+      node = node->next;
+   }
+   return changed;
+}
+
+static bool thread_jump( struct codegen* codegen, struct c_point** point ) {
+   // Bound the walk so a loop made only of jumps does not hang.
+   enum { MAX_HOPS = 32 };
+   struct c_point* target = *point;
+   int hops = 0;
+   struct c_jump* jump = find_goto( target );
+   while ( jump && jump->point != target && hops < MAX_HOPS ) {
+      target = jump->point;
+      jump = find_goto( target );
+      ++hops;
+   }
+   if ( target != *point ) {
+      *point = target;
+      ++codegen->optimize_stats.threaded_jumps;
+      return true;
+   }
+   return false;
+}
+
+// Returns the unconditional jump that directly follows a point, if any.
+static struct c_jump* find_goto( struct c_point* point ) {
+   struct c_node* node = point->node.next;
+   while ( node && node->type == C_NODE_POINT ) {
+      node = node->next;
+   }
+   if ( node && node->type == C_NODE_JUMP ) {
+      struct c_jump* jump = ( struct c_jump* ) node;
+      if ( jump->opcode == PCD_GOTO ) {
+         return jump;
+      }
+   }
+   return NULL;
+}
+
+// Deletes the nodes between an instruction that never falls through and the
+// next point that something jumps to. Points nothing jumps to go as well.
+static bool remove_unreachable( struct codegen* codegen ) {
+   mark_used_points( codegen );
+   bool changed = false;
+   bool reachable = true;
+   struct c_node** link = &codegen->node_head;
+   while ( *link ) {
+      struct c_node* node = *link;
+      if ( node->type == C_NODE_POINT ) {
+         if ( ( ( struct c_point* ) node )->used ) {
+            reachable = true;
+         }
+         else {
+            *link = node->next;
+            continue;
+         }
+      }
+      else if ( ! reachable ) {
+         *link = node->next;
+         ++codegen->optimize_stats.dead_nodes;
+         changed = true;
+         continue;
+      }
+      if ( is_terminator( node ) ) {
+         reachable = false;
+      }
+      link = &node->next;
+   }
+   return changed;
+}
+
+static void mark_used_points( struct codegen* codegen ) {
+   struct c_node* node = codegen->node_head;
+   while ( node ) {
+      if ( node->type == C_NODE_POINT ) {
+         ( ( struct c_point* ) node )->used = false;
+      }
+      node = node->next;
+   }
+   node = codegen->node_head;
+   while ( node ) {
+      switch ( node->type ) {
+      case C_NODE_JUMP:
+         mark_point( ( ( struct c_jump* ) node )->point );
+         break;
+      case C_NODE_CASEJUMP:
+         mark_point( ( ( struct c_casejump* ) node )->point );
+         break;
+      case C_NODE_SORTEDCASEJUMP: {
+            struct c_casejump* jump =
+               ( ( struct c_sortedcasejump* ) node )->head;
+            while ( jump ) {
+               mark_point( jump->point );
+               jump = jump->next;
+            }
+         }
+         break;
+      case C_NODE_PCODE: {
+            struct c_pcode* pcode = ( struct c_pcode* ) node;
+            if ( pcode->points ) {
+               for ( int i = 0; i < pcode->argc; ++i ) {
+                  mark_point( pcode->points[ i ] );
+               }
+            }
+         }
+         break;
+      default:
+         break;
+      }
+      node = node->next;
+   }
+}
+
+static void mark_point( struct c_point* point ) {
+   if ( point ) {
+      point->used = true;
+   }
+}
+
+static bool is_terminator( struct c_node* node ) {
+   switch ( node->type ) {
+   case C_NODE_JUMP:
+      return ( ( struct c_jump* ) node )->opcode == PCD_GOTO;
+   case C_NODE_PCODE:
+      switch ( ( ( struct c_pcode* ) node )->code ) {
+      case PCD_TERMINATE:
+      case PCD_RESTART:
+      case PCD_RETURNVOID:
+      case PCD_RETURNVAL:
+         return true;
+      default:
+         return false;
+      }
+   default:
+      return false;
+   }
+}
+
+// Rewrites short instruction sequences into cheaper ones. Points are never
+// crossed: something may jump to them.
+
+static bool run_peephole( struct codegen* codegen ) {
+   bool changed = false;
+   struct c_node** link = &codegen->node_head;
+   while ( *link ) {
+      if ( rewrite( codegen, link ) ) {
+         changed = true;
+      }
+      else {
+         link = &( *link )->next;
+      }
+   }
+   return changed;
+}
+
+// Tries the patterns starting at the node in `link`. Returns true when the
+// node was removed or replaced, in which case the same link is tried again.
+static bool rewrite( struct codegen* codegen, struct c_node** link ) {
+   struct c_node* node = *link;
+   if ( node->type == C_NODE_JUMP ) {
+      return rewrite_goto( codegen, link, ( struct c_jump* ) node );
+   }
+   struct c_pcode* pcode = get_pcode( node );
+   if ( ! pcode || ! node->next ) {
+      return false;
+   }
+   struct c_pcode* next = get_pcode( node->next );
+   if ( pcode->code == PCD_NEGATELOGICAL ) {
+      return rewrite_negation( codegen, link, pcode, node->next );
+   }
+   else if ( ! next ) {
+      return false;
+   }
+   else if ( rewrite_assign_push( codegen, pcode, next ) ) {
+      return true;
+   }
+   else if ( next->code == PCD_DROP ) {
+      return rewrite_dropped_push( codegen, link, pcode, next );
+   }
+   else if ( pcode->code == PCD_SWAP ) {
+      return rewrite_swap( codegen, link, pcode, next );
+   }
+   return rewrite_arithmetic( codegen, link, pcode, next );
+}
+
+// ASSIGNSCRIPTVAR x; PUSHSCRIPTVAR x => DUP; ASSIGNSCRIPTVAR x
+static bool rewrite_assign_push( struct codegen* codegen,
+   struct c_pcode* assign, struct c_pcode* push ) {
+   // DUP is not part of the original instruction set.
+   if ( codegen->lang == LANG_ACS95 ) {
+      return false;
+   }
+   int push_code = get_push_code( assign->code );
+   // Leave a dropped load to the rewrite that deletes it.
+   struct c_pcode* drop = push->node.next ? get_pcode( push->node.next ) :
+      NULL;
+   if ( drop && drop->code == PCD_DROP ) {
+      return false;
+   }
+   if ( push_code != PCD_NONE && push->code == push_code &&
+      push->args[ 0 ] == assign->args[ 0 ] ) {
+      push->code = assign->code;
+      assign->code = PCD_DUP;
+      assign->argc = 0;
+      ++codegen->optimize_stats.dups;
+      return true;
+   }
+   return false;
+}
+
+// PUSHNUMBER 0; DROP => (nothing)
+static bool rewrite_dropped_push( struct codegen* codegen,
+   struct c_node** link, struct c_pcode* push, struct c_pcode* drop ) {
+   if ( is_plain_push( push ) ) {
+      *link = drop->node.next;
+      ++codegen->optimize_stats.dropped_pushes;
+      return true;
+   }
+   return false;
+}
+
+// SWAP; SWAP => (nothing)
+static bool rewrite_swap( struct codegen* codegen, struct c_node** link,
+   struct c_pcode* pcode, struct c_pcode* next ) {
+   if ( next->code == PCD_SWAP ) {
+      *link = next->node.next;
+      ++codegen->optimize_stats.swaps;
+      return true;
+   }
+   return false;
+}
+
+// NEGATELOGICAL; NEGATELOGICAL; IFGOTO => IFGOTO
+// NEGATELOGICAL; IFGOTO => IFNOTGOTO
+static bool rewrite_negation( struct codegen* codegen, struct c_node** link,
+   struct c_pcode* pcode, struct c_node* next ) {
+   struct c_pcode* next_pcode = get_pcode( next );
+   if ( next_pcode && next_pcode->code == PCD_NEGATELOGICAL &&
+      next->next && next->next->type == C_NODE_JUMP ) {
+      struct c_jump* jump = ( struct c_jump* ) next->next;
+      if ( jump->opcode == PCD_IFGOTO || jump->opcode == PCD_IFNOTGOTO ) {
+         *link = &jump->node;
+         ++codegen->optimize_stats.negations;
+         return true;
+      }
+   }
+   else if ( next->type == C_NODE_JUMP ) {
+      struct c_jump* jump = ( struct c_jump* ) next;
+      if ( jump->opcode == PCD_IFGOTO || jump->opcode == PCD_IFNOTGOTO ) {
+         jump->opcode = ( jump->opcode == PCD_IFGOTO ) ?
+            PCD_IFNOTGOTO : PCD_IFGOTO;
+         *link = next;
+         ++codegen->optimize_stats.negations;
+         return true;
+      }
+   }
+   return false;
+}
+
+// GOTO L; L: => L:
+static bool rewrite_goto( struct codegen* codegen, struct c_node** link,
+   struct c_jump* jump ) {
+   if ( jump->opcode != PCD_GOTO ) {
+      return false;
+   }
+   struct c_node* node = jump->node.next;
+   while ( node && node->type == C_NODE_POINT ) {
+      if ( node == &jump->point->node ) {
+         *link = jump->node.next;
+         ++codegen->optimize_stats.gotos;
+         return true;
+      }
+      node = node->next;
+   }
+   return false;
+}
+
+// Arithmetic whose operands are known. Only the values pushed right before
+// an operation are considered, so no operand is evaluated out of order.
+static bool rewrite_arithmetic( struct codegen* codegen,
+   struct c_node** link, struct c_pcode* pcode, struct c_pcode* next ) {
+   if ( is_number( pcode ) &&
+      rewrite_right_operand( codegen, link, pcode, next ) ) {
+      return true;
+   }
+   struct c_pcode* op = next->node.next ? get_pcode( next->node.next ) :
+      NULL;
+   if ( ! op ) {
+      return false;
+   }
+   if ( is_number( pcode ) && is_number( next ) ) {
+      return rewrite_constant_operation( codegen, pcode, next, op );
+   }
+   else if ( is_number( next ) && is_pure_push( pcode ) ) {
+      return rewrite_absorbed_operand( codegen, pcode, next, op );
+   }
+   else if ( is_number( pcode ) && is_pure_push( next ) ) {
+      return rewrite_left_operand( codegen, link, pcode, next, op );
+   }
+   return false;
+}
+
+// PUSHNUMBER 0; ADD => (nothing)
+// PUSHNUMBER 8; MULTIPLY => PUSHNUMBER 3; LSHIFT
+static bool rewrite_right_operand( struct codegen* codegen,
+   struct c_node** link, struct c_pcode* number, struct c_pcode* op ) {
+   if ( is_identity( op->code, number->args[ 0 ] ) ) {
+      *link = op->node.next;
+      ++codegen->optimize_stats.identities;
+      return true;
+   }
+   // Division and modulo round toward zero, so they cannot be replaced by a
+   // shift or a mask when the dividend might be negative.
+   int shift = get_shift( number->args[ 0 ] );
+   if ( op->code == PCD_MULTIPLY && shift > 0 ) {
+      number->args[ 0 ] = shift;
+      op->code = PCD_LSHIFT;
+      ++codegen->optimize_stats.shifts;
+      return true;
+   }
+   else if ( op->code == PCD_MODULUS && shift > 0 ) {
+      return rewrite_modulo_test( codegen, number, op );
+   }
+   return false;
+}
+
+// A remainder of zero means the low bits of the dividend are zero, whatever
+// its sign. When only that is tested, the modulo can become a mask.
+// PUSHNUMBER 4; MODULUS; IFGOTO => PUSHNUMBER 3; ANDBITWISE; IFGOTO
+static bool rewrite_modulo_test( struct codegen* codegen,
+   struct c_pcode* number, struct c_pcode* op ) {
+   struct c_node* test = op->node.next;
+   if ( ! test ) {
+      return false;
+   }
+   struct c_pcode* zero = get_pcode( test );
+   if ( zero && is_number( zero ) && zero->args[ 0 ] == 0 && test->next ) {
+      struct c_pcode* compare = get_pcode( test->next );
+      if ( ! ( compare && ( compare->code == PCD_EQ ||
+         compare->code == PCD_NE ) ) ) {
+         return false;
+      }
+   }
+   else if ( ! is_zero_test( test ) ) {
+      return false;
+   }
+   number->args[ 0 ] = number->args[ 0 ] - 1;
+   op->code = PCD_ANDBITWISE;
+   ++codegen->optimize_stats.shifts;
+   return true;
+}
+
+// PUSHNUMBER 2; PUSHNUMBER 3; ADD => PUSHNUMBER 5
+static bool rewrite_constant_operation( struct codegen* codegen,
+   struct c_pcode* lside, struct c_pcode* rside, struct c_pcode* op ) {
+   int result = 0;
+   if ( fold_operation( op->code, lside->args[ 0 ], rside->args[ 0 ],
+      &result ) ) {
+      lside->args[ 0 ] = result;
+      lside->node.next = op->node.next;
+      ++codegen->optimize_stats.folds;
+      return true;
+   }
+   return false;
+}
+
+// PUSHSCRIPTVAR x; PUSHNUMBER 0; MULTIPLY => PUSHNUMBER 0
+static bool rewrite_absorbed_operand( struct codegen* codegen,
+   struct c_pcode* push, struct c_pcode* number, struct c_pcode* op ) {
+   int result = 0;
+   if ( is_absorbing( op->code, number->args[ 0 ], &result ) ||
+      ( op->code == PCD_MODULUS && ( number->args[ 0 ] == 1 ||
+      number->args[ 0 ] == -1 ) ) ) {
+      push->code = PCD_PUSHNUMBER;
+      push->args[ 0 ] = result;
+      push->argc = 1;
+      push->node.next = op->node.next;
+      ++codegen->optimize_stats.folds;
+      return true;
+   }
+   return false;
+}
+
+// PUSHNUMBER 0; PUSHSCRIPTVAR x; ADD => PUSHSCRIPTVAR x
+// PUSHNUMBER 4; PUSHSCRIPTVAR x; MULTIPLY =>
+//    PUSHSCRIPTVAR x; PUSHNUMBER 2; LSHIFT
+static bool rewrite_left_operand( struct codegen* codegen,
+   struct c_node** link, struct c_pcode* number, struct c_pcode* push,
+   struct c_pcode* op ) {
+   if ( ! is_commutative( op->code ) ) {
+      return false;
+   }
+   int result = 0;
+   int shift = get_shift( number->args[ 0 ] );
+   if ( is_identity( op->code, number->args[ 0 ] ) ) {
+      *link = &push->node;
+      push->node.next = op->node.next;
+      ++codegen->optimize_stats.identities;
+      return true;
+   }
+   else if ( is_absorbing( op->code, number->args[ 0 ], &result ) ) {
+      number->node.next = op->node.next;
+      ++codegen->optimize_stats.folds;
+      return true;
+   }
+   else if ( op->code == PCD_MULTIPLY && shift > 0 ) {
+      *link = &push->node;
+      push->node.next = &number->node;
+      number->node.next = &op->node;
+      number->args[ 0 ] = shift;
+      op->code = PCD_LSHIFT;
+      ++codegen->optimize_stats.shifts;
+      return true;
+   }
+   return false;
+}
+
+// Performs the operation the way the game does. Returns false for an
+// operation the game would report as an error, or whose result is not
+// defined.
+static bool fold_operation( int code, int l, int r, int* result ) {
+   unsigned int ul = ( unsigned int ) l;
+   unsigned int ur = ( unsigned int ) r;
+   switch ( code ) {
+   case PCD_DIVIDE:
+   case PCD_MODULUS:
+      if ( r == 0 || ( r == -1 && l == INT_MIN ) ) {
+         return false;
+      }
+      break;
+   case PCD_LSHIFT:
+   case PCD_RSHIFT:
+      if ( r < 0 || r >= 32 ) {
+         return false;
+      }
+      break;
+   default:
+      break;
+   }
+   switch ( code ) {
+   case PCD_ADD: *result = ( int ) ( ul + ur ); break;
+   case PCD_SUBTRACT: *result = ( int ) ( ul - ur ); break;
+   case PCD_MULTIPLY: *result = ( int ) ( ul * ur ); break;
+   case PCD_DIVIDE: *result = l / r; break;
+   case PCD_MODULUS: *result = l % r; break;
+   case PCD_LSHIFT: *result = ( int ) ( ul << r ); break;
+   case PCD_RSHIFT: *result = l >> r; break;
+   case PCD_ORBITWISE: *result = l | r; break;
+   case PCD_EORBITWISE: *result = l ^ r; break;
+   case PCD_ANDBITWISE: *result = l & r; break;
+   case PCD_EQ: *result = ( l == r ); break;
+   case PCD_NE: *result = ( l != r ); break;
+   case PCD_LT: *result = ( l < r ); break;
+   case PCD_LE: *result = ( l <= r ); break;
+   case PCD_GT: *result = ( l > r ); break;
+   case PCD_GE: *result = ( l >= r ); break;
+   default:
+      return false;
+   }
+   return true;
+}
+
+// Tells whether the operation leaves the other operand unchanged when
+// `value` is the right operand.
+static bool is_identity( int code, int value ) {
+   switch ( code ) {
+   case PCD_ADD:
+   case PCD_SUBTRACT:
+   case PCD_ORBITWISE:
+   case PCD_EORBITWISE:
+   case PCD_LSHIFT:
+   case PCD_RSHIFT:
+      return ( value == 0 );
+   case PCD_MULTIPLY:
+   case PCD_DIVIDE:
+      return ( value == 1 );
+   case PCD_ANDBITWISE:
+      return ( value == -1 );
+   default:
+      return false;
+   }
+}
+
+// Tells whether the operation gives the same result for every other operand.
+static bool is_absorbing( int code, int value, int* result ) {
+   switch ( code ) {
+   case PCD_MULTIPLY:
+   case PCD_ANDBITWISE:
+      *result = 0;
+      return ( value == 0 );
+   case PCD_ORBITWISE:
+      *result = -1;
+      return ( value == -1 );
+   default:
+      return false;
+   }
+}
+
+static bool is_commutative( int code ) {
+   switch ( code ) {
+   case PCD_ADD:
+   case PCD_MULTIPLY:
+   case PCD_ORBITWISE:
+   case PCD_EORBITWISE:
+   case PCD_ANDBITWISE:
+      return true;
+   default:
+      return false;
+   }
+}
+
+static bool is_zero_test( struct c_node* node ) {
+   if ( node->type == C_NODE_JUMP ) {
+      struct c_jump* jump = ( struct c_jump* ) node;
+      return ( jump->opcode == PCD_IFGOTO || jump->opcode == PCD_IFNOTGOTO );
+   }
+   struct c_pcode* pcode = get_pcode( node );
+   return ( pcode && pcode->code == PCD_NEGATELOGICAL );
+}
+
+// Returns the exponent when the value is a power of two, or -1.
+static int get_shift( int value ) {
+   if ( value <= 0 || ( value & ( value - 1 ) ) != 0 ) {
+      return -1;
+   }
+   int shift = 0;
+   while ( value > 1 ) {
+      value >>= 1;
+      ++shift;
+   }
+   return shift;
+}
+
+// A number pushed by the compiler, and not an address filled in later.
+static bool is_number( struct c_pcode* pcode ) {
+   return ( pcode->code == PCD_PUSHNUMBER && pcode->argc == 1 &&
+      ! pcode->patch );
+}
+
+// A push that has no effect other than placing a value on the stack.
+static bool is_pure_push( struct c_pcode* pcode ) {
+   return ( is_plain_push( pcode ) && ! pcode->patch );
+}
+
+// Only instructions written through the optimizing path take part. Inline
+// assembly is left as the user wrote it.
+static struct c_pcode* get_pcode( struct c_node* node ) {
+   if ( node->type == C_NODE_PCODE ) {
+      struct c_pcode* pcode = ( struct c_pcode* ) node;
+      if ( pcode->optimize ) {
+         return pcode;
+      }
+   }
+   return NULL;
+}
+
+static bool is_plain_push( struct c_pcode* pcode ) {
+   switch ( pcode->code ) {
+   case PCD_PUSHNUMBER:
+   case PCD_PUSHSCRIPTVAR:
+   case PCD_PUSHMAPVAR:
+   case PCD_PUSHWORLDVAR:
+   case PCD_PUSHGLOBALVAR:
+   case PCD_DUP:
+      return true;
+   default:
+      return false;
+   }
+}
+
+static int get_push_code( int assign_code ) {
+   switch ( assign_code ) {
+   case PCD_ASSIGNSCRIPTVAR:
+      return PCD_PUSHSCRIPTVAR;
+   case PCD_ASSIGNMAPVAR:
+      return PCD_PUSHMAPVAR;
+   case PCD_ASSIGNWORLDVAR:
+      return PCD_PUSHWORLDVAR;
+   case PCD_ASSIGNGLOBALVAR:
+      return PCD_PUSHGLOBALVAR;
+   default:
+      return PCD_NONE;
+   }
+}
+
+static void update_tail( struct codegen* codegen ) {
+   struct c_node* node = codegen->node_head;
+   codegen->node_tail = node;
+   while ( node ) {
+      codegen->node_tail = node;
+      node = node->next;
+   }
+   codegen->node = codegen->node_tail;
+}
+
+void c_print_optimize_stats( struct codegen* codegen ) {
+   #define PLURAL( count ) count, ( count == 1 ? "" : "s" )
+   t_diag( codegen->task, DIAG_NONE,
+      "optimizer rewrites:\n"
+      "  %d assignment%s followed by a load of the same variable\n"
+      "  %d value%s pushed and dropped\n"
+      "  %d double swap%s\n"
+      "  %d negation%s before a conditional jump\n"
+      "  %d operation%s on constants folded\n"
+      "  %d operation%s with no effect removed\n"
+      "  %d operation%s replaced by a bit operation\n"
+      "  %d jump%s to the next instruction\n"
+      "  %d jump%s threaded through another jump\n"
+      "  %d unreachable node%s removed\n"
+      "  %d local variable slot%s saved\n"
+      "  %d function call%s inlined",
+      PLURAL( codegen->optimize_stats.dups ),
+      PLURAL( codegen->optimize_stats.dropped_pushes ),
+      PLURAL( codegen->optimize_stats.swaps ),
+      PLURAL( codegen->optimize_stats.negations ),
+      PLURAL( codegen->optimize_stats.folds ),
+      PLURAL( codegen->optimize_stats.identities ),
+      PLURAL( codegen->optimize_stats.shifts ),
+      PLURAL( codegen->optimize_stats.gotos ),
+      PLURAL( codegen->optimize_stats.threaded_jumps ),
+      PLURAL( codegen->optimize_stats.dead_nodes ),
+      PLURAL( codegen->optimize_stats.packed_slots ),
+      PLURAL( codegen->optimize_stats.inlined_calls ) );
+   #undef PLURAL
+}
+
+// Gives the local variables of the current function the fewest script
+// variable slots, by letting variables whose values are never needed at the
+// same time share a slot. `start` is the first slot that may be renumbered;
+// the slots before it hold the parameters. Returns the new size.
+int c_pack_local_vars( struct codegen* codegen, int start, int size ) {
+   // Interference is kept as a bit matrix, so bound its size.
+   enum { MAX_SLOTS = 1024 };
+   struct slot_packing packing;
+   packing.start = start;
+   packing.count = size - start;
+   if ( packing.count < 2 || packing.count > MAX_SLOTS ) {
+      return size;
+   }
+   packing.words = ( packing.count + 31 ) / 32;
+   if ( ! collect_nodes( &packing, codegen->node_head ) ) {
+      mem_free( packing.nodes );
+      return size;
+   }
+   size_t set_size = sizeof( unsigned int ) * packing.words;
+   packing.live = mem_alloc( set_size * packing.node_count );
+   memset( packing.live, 0, set_size * packing.node_count );
+   packing.live_out = mem_alloc( set_size );
+   packing.interference = mem_alloc( set_size * packing.count );
+   memset( packing.interference, 0, set_size * packing.count );
+   packing.colors = mem_alloc( sizeof( int ) * packing.count );
+   compute_liveness( &packing );
+   build_interference( &packing );
+   int used_slots = color_slots( &packing );
+   if ( used_slots < packing.count ) {
+      rename_slots( &packing );
+      codegen->optimize_stats.packed_slots += packing.count - used_slots;
+      size = start + used_slots;
+   }
+   for ( int i = 0; i < packing.node_count; ++i ) {
+      if ( packing.nodes[ i ]->type == C_NODE_POINT ) {
+         ( ( struct c_point* ) packing.nodes[ i ] )->obj_pos = 0;
+      }
+   }
+   mem_free( packing.nodes );
+   mem_free( packing.live );
+   mem_free( packing.live_out );
+   mem_free( packing.interference );
+   mem_free( packing.colors );
+   return size;
+}
+
+// Finds which of the `size` slots from `start` are live on reaching one of
+// `points`, in the code from `head` onwards, and sets `live[ i ]` for slot
+// `start + i`. Returns false when the code cannot be analysed.
+bool c_find_live_slots( struct c_node* head, int start, int size,
+   struct list* points, bool* live ) {
+   enum { MAX_SLOTS = 1024 };
+   struct slot_packing packing;
+   packing.start = start;
+   packing.count = size;
+   if ( packing.count < 1 || packing.count > MAX_SLOTS ) {
+      return false;
+   }
+   packing.words = ( packing.count + 31 ) / 32;
+   if ( ! collect_nodes( &packing, head ) ) {
+      mem_free( packing.nodes );
+      return false;
+   }
+   size_t set_size = sizeof( unsigned int ) * packing.words;
+   packing.live = mem_alloc( set_size * packing.node_count );
+   memset( packing.live, 0, set_size * packing.node_count );
+   packing.live_out = mem_alloc( set_size );
+   compute_liveness( &packing );
+   bool found = true;
+   struct list_iter iter;
+   list_iterate( points, &iter );
+   while ( ! list_end( &iter ) ) {
+      int pos = find_point( &packing, list_data( &iter ) );
+      if ( pos == -1 ) {
+         found = false;
+         break;
+      }
+      const unsigned int* live_in = packing.live + packing.words * pos;
+      for ( int slot = 0; slot < packing.count; ++slot ) {
+         if ( test_bit( live_in, slot ) ) {
+            live[ slot ] = true;
+         }
+      }
+      list_next( &iter );
+   }
+   for ( int i = 0; i < packing.node_count; ++i ) {
+      if ( packing.nodes[ i ]->type == C_NODE_POINT ) {
+         ( ( struct c_point* ) packing.nodes[ i ] )->obj_pos = 0;
+      }
+   }
+   mem_free( packing.nodes );
+   mem_free( packing.live );
+   mem_free( packing.live_out );
+   return found;
+}
+
+// Numbers the nodes, using the position field of a point to hold its number
+// until the code is written. Inline assembly can refer to variables and
+// labels in ways the analysis does not follow, so its presence stops the
+// packing.
+static bool collect_nodes( struct slot_packing* packing,
+   struct c_node* head ) {
+   int count = 0;
+   struct c_node* node = head;
+   while ( node ) {
+      ++count;
+      node = node->next;
+   }
+   packing->nodes = mem_alloc( sizeof( *packing->nodes ) * ( count + 1 ) );
+   packing->node_count = count;
+   count = 0;
+   node = head;
+   while ( node ) {
+      if ( node->type == C_NODE_PCODE &&
+         ! ( ( struct c_pcode* ) node )->optimize ) {
+         return false;
+      }
+      if ( node->type == C_NODE_POINT ) {
+         ( ( struct c_point* ) node )->obj_pos = count;
+      }
+      packing->nodes[ count ] = node;
+      ++count;
+      node = node->next;
+   }
+   return true;
+}
+
+static bool get_slot_access( struct slot_packing* packing,
+   struct c_node* node, int* slot, bool* use, bool* def ) {
+   if ( node->type != C_NODE_PCODE ) {
+      return false;
+   }
+   struct c_pcode* pcode = ( struct c_pcode* ) node;
+   switch ( pcode->code ) {
+   case PCD_ASSIGNSCRIPTVAR:
+      *use = false;
+      *def = true;
+      break;
+   case PCD_PUSHSCRIPTVAR:
+      *use = true;
+      *def = false;
+      break;
+   case PCD_ADDSCRIPTVAR:
+   case PCD_SUBSCRIPTVAR:
+   case PCD_MULSCRIPTVAR:
+   case PCD_DIVSCRIPTVAR:
+   case PCD_MODSCRIPTVAR:
+   case PCD_INCSCRIPTVAR:
+   case PCD_DECSCRIPTVAR:
+   case PCD_ANDSCRIPTVAR:
+   case PCD_EORSCRIPTVAR:
+   case PCD_ORSCRIPTVAR:
+   case PCD_LSSCRIPTVAR:
+   case PCD_RSSCRIPTVAR:
+      *use = true;
+      *def = true;
+      break;
+   default:
+      return false;
+   }
+   *slot = pcode->args[ 0 ] - packing->start;
+   return ( *slot >= 0 && *slot < packing->count );
+}
+
+// Backward data-flow over the nodes until the live-in sets stop changing.
+static void compute_liveness( struct slot_packing* packing ) {
+   size_t set_size = sizeof( unsigned int ) * packing->words;
+   bool changed = true;
+   while ( changed ) {
+      changed = false;
+      for ( int i = packing->node_count - 1; i >= 0; --i ) {
+         compute_live_out( packing, i );
+         int slot;
+         bool use;
+         bool def;
+         if ( get_slot_access( packing, packing->nodes[ i ], &slot, &use,
+            &def ) ) {
+            if ( def && ! use ) {
+               packing->live_out[ slot / 32 ] &= ~( 1u << ( slot % 32 ) );
+            }
+            if ( use ) {
+               set_bit( packing->live_out, slot );
+            }
+         }
+         unsigned int* live_in = packing->live + packing->words * i;
+         if ( memcmp( live_in, packing->live_out, set_size ) != 0 ) {
+            memcpy( live_in, packing->live_out, set_size );
+            changed = true;
+         }
+      }
+   }
+}
+
+// Fills `live_out` with the slots live on leaving node `i`.
+static void compute_live_out( struct slot_packing* packing, int i ) {
+   memset( packing->live_out, 0, sizeof( unsigned int ) * packing->words );
+   struct c_node* node = packing->nodes[ i ];
+   bool falls_through = true;
+   switch ( node->type ) {
+   case C_NODE_JUMP: {
+         // A jump to code outside the nodes, such as a call to a nested
+         // function whose prologue is not written yet, is taken to come back
+         // to the next node.
+         struct c_jump* jump = ( struct c_jump* ) node;
+         int target = find_point( packing, jump->point );
+         if ( target != -1 ) {
+            add_live_in( packing, target );
+            falls_through = ( jump->opcode != PCD_GOTO );
+         }
+      }
+      break;
+   case C_NODE_CASEJUMP: {
+         struct c_casejump* jump = ( struct c_casejump* ) node;
+         int target = find_point( packing, jump->point );
+         if ( target != -1 ) {
+            add_live_in( packing, target );
+         }
+      }
+      break;
+   case C_NODE_SORTEDCASEJUMP: {
+         struct c_casejump* jump = ( ( struct c_sortedcasejump* ) node )->head;
+         while ( jump ) {
+            int target = find_point( packing, jump->point );
+            if ( target != -1 ) {
+               add_live_in( packing, target );
+            }
+            jump = jump->next;
+         }
+      }
+      break;
+   case C_NODE_PCODE:
+      switch ( ( ( struct c_pcode* ) node )->code ) {
+      case PCD_TERMINATE:
+      case PCD_RESTART:
+      case PCD_RETURNVOID:
+      case PCD_RETURNVAL:
+         falls_through = false;
+         break;
+      default:
+         break;
+      }
+      break;
+   default:
+      break;
+   }
+   if ( falls_through && i + 1 < packing->node_count ) {
+      add_live_in( packing, i + 1 );
+   }
+}
+
+static void add_live_in( struct slot_packing* packing, int i ) {
+   const unsigned int* live_in = packing->live + packing->words * i;
+   for ( int k = 0; k < packing->words; ++k ) {
+      packing->live_out[ k ] |= live_in[ k ];
+   }
+}
+
+// Returns the number of the point, or -1 when the point is not among the
+// nodes.
+static int find_point( struct slot_packing* packing, struct c_point* point ) {
+   if ( point && point->obj_pos >= 0 && point->obj_pos < packing->node_count &&
+      packing->nodes[ point->obj_pos ] == &point->node ) {
+      return point->obj_pos;
+   }
+   return -1;
+}
+
+// A slot written while another slot is live cannot share with it. A slot
+// live on entry relies on locals starting at zero, so it shares with none.
+static void build_interference( struct slot_packing* packing ) {
+   for ( int i = 0; i < packing->node_count; ++i ) {
+      int slot;
+      bool use;
+      bool def;
+      if ( get_slot_access( packing, packing->nodes[ i ], &slot, &use,
+         &def ) && def ) {
+         compute_live_out( packing, i );
+         for ( int other = 0; other < packing->count; ++other ) {
+            if ( other != slot && test_bit( packing->live_out, other ) ) {
+               add_interference( packing, slot, other );
+            }
+         }
+      }
+   }
+   if ( packing->node_count > 0 ) {
+      for ( int slot = 0; slot < packing->count; ++slot ) {
+         if ( test_bit( packing->live, slot ) ) {
+            for ( int other = 0; other < packing->count; ++other ) {
+               if ( other != slot ) {
+                  add_interference( packing, slot, other );
+               }
+            }
+         }
+      }
+   }
+}
+
+static void add_interference( struct slot_packing* packing, int a, int b ) {
+   set_bit( packing->interference + packing->words * a, b );
+   set_bit( packing->interference + packing->words * b, a );
+}
+
+// Greedily gives each slot the lowest color none of its neighbors has.
+// Returns the number of colors used.
+static int color_slots( struct slot_packing* packing ) {
+   bool* taken = mem_alloc( sizeof( *taken ) * packing->count );
+   int used = 0;
+   for ( int slot = 0; slot < packing->count; ++slot ) {
+      const unsigned int* neighbors = packing->interference +
+         packing->words * slot;
+      for ( int color = 0; color < used; ++color ) {
+         taken[ color ] = false;
+      }
+      for ( int other = 0; other < slot; ++other ) {
+         if ( test_bit( neighbors, other ) ) {
+            taken[ packing->colors[ other ] ] = true;
+         }
+      }
+      int color = 0;
+      while ( color < used && taken[ color ] ) {
+         ++color;
+      }
+      packing->colors[ slot ] = color;
+      if ( color == used ) {
+         ++used;
+      }
+   }
+   mem_free( taken );
+   return used;
+}
+
+static void rename_slots( struct slot_packing* packing ) {
+   for ( int i = 0; i < packing->node_count; ++i ) {
+      int slot;
+      bool use;
+      bool def;
+      if ( get_slot_access( packing, packing->nodes[ i ], &slot, &use,
+         &def ) ) {
+         struct c_pcode* pcode = ( struct c_pcode* ) packing->nodes[ i ];
+         pcode->args[ 0 ] = packing->start + packing->colors[ slot ];
+      }
+   }
+}
+
+static bool test_bit( const unsigned int* set, int bit ) {
+   return ( set[ bit / 32 ] & ( 1u << ( bit % 32 ) ) ) != 0;
+}
+
+static void set_bit( unsigned int* set, int bit ) {
+   set[ bit / 32 ] |= 1u << ( bit % 32 );
+}
@@ -39,12 +39,11 @@ void c_init( struct codegen* codegen, struct task* task ) {
    codegen->node = NULL;
    codegen->node_head = NULL;
    codegen->node_tail = NULL;
-   for ( int i = 0; i < C_NODE_TOTAL; ++i ) {
-      codegen->free_nodes[ i ] = NULL;
-   }
+   codegen->node_chunks = NULL;
+   codegen->node_chunk = NULL;
+   codegen->patch_nodes = NULL;
+   codegen->patch_capacity = 0;
    codegen->pcode = NULL;
-   codegen->pcodearg_tail = NULL;
-   codegen->free_pcode_args = NULL;
    codegen->assert_prefix = NULL;
    codegen->runtime_index = 0;
    list_init( &codegen->used_strings );
@@ -58,6 +57,18 @@ void c_init( struct codegen* codegen, struct task* task ) {
    list_init( &codegen->shary.vars );
    list_init( &codegen->shary.dims );
    codegen->shary.index = 0;
+   codegen->optimize_stats.dups = 0;
+   codegen->optimize_stats.dropped_pushes = 0;
+   codegen->optimize_stats.swaps = 0;
+   codegen->optimize_stats.negations = 0;
+   codegen->optimize_stats.folds = 0;
+   codegen->optimize_stats.identities = 0;
+   codegen->optimize_stats.shifts = 0;
+   codegen->optimize_stats.gotos = 0;
+   codegen->optimize_stats.threaded_jumps = 0;
+   codegen->optimize_stats.dead_nodes = 0;
+   codegen->optimize_stats.packed_slots = 0;
+   codegen->optimize_stats.inlined_calls = 0;
    codegen->shary.dim_counter = 0;
    codegen->shary.size = 0;
    codegen->shary.diminfo_size = 0;
@@ -172,7 +183,7 @@ static void clarify_vars( struct codegen* codegen ) {
    list_iterate( &codegen->task->library_main->vars, &i );
    while ( ! list_end( &i ) ) {
       struct var* var = list_data( &i );
-      if ( var->storage == STORAGE_MAP && ! var->hidden ) {
+      if ( var->storage == STORAGE_MAP && ! var->hidden && var->reachable ) {
          list_append( &codegen->vars, var );
          ++count;
       }
@@ -186,7 +197,7 @@ static void clarify_vars( struct codegen* codegen ) {
       list_iterate( &lib->vars, &k );
       while ( ! list_end( &k ) ) {
          struct var* var = list_data( &k );
-         if ( var->storage == STORAGE_MAP && var->used ) {
+         if ( var->storage == STORAGE_MAP && var->reachable ) {
             list_append( &codegen->imported_vars, var );
             ++count;
          }
@@ -198,7 +209,7 @@ static void clarify_vars( struct codegen* codegen ) {
    list_iterate( &codegen->task->library_main->external_vars, &i );
    while ( ! list_end( &i ) ) {
       struct var* var = list_data( &i );
-      if ( var->imported && var->used ) {
+      if ( var->imported && var->reachable ) {
          list_append( &codegen->imported_vars, var );
          ++count;
       }
@@ -212,7 +223,8 @@ static void clarify_vars( struct codegen* codegen ) {
    while ( ! list_end( &i ) ) {
       struct var* var = list_data( &i );
       if ( var->storage == STORAGE_MAP && ( var->desc == DESC_ARRAY ||
-         var->desc == DESC_STRUCTVAR ) && var->hidden && var->addr_taken ) {
+         var->desc == DESC_STRUCTVAR ) && var->hidden && var->addr_taken &&
+         var->reachable ) {
          list_append( &codegen->shary.vars, var );
       }
       list_next( &i );
@@ -228,7 +240,8 @@ static void clarify_vars( struct codegen* codegen ) {
    list_iterate( &codegen->task->library_main->vars, &i );
    while ( ! list_end( &i ) ) {
       struct var* var = list_data( &i );
-      if ( var->storage == STORAGE_MAP && var->hidden && ! var->addr_taken ) {
+      if ( var->storage == STORAGE_MAP && var->hidden && ! var->addr_taken &&
+         var->reachable ) {
          if ( count < MAX_MAP_LOCATIONS ) {
             list_append( &codegen->vars, var );
             ++count;
@@ -299,7 +312,7 @@ static void clarify_funcs( struct codegen* codegen ) {
       while ( ! list_end( &k ) ) {
          struct func* func = list_data( &k );
          struct func_user* impl = func->impl;
-         if ( impl->usage ) {
+         if ( impl->reachable ) {
             list_append( &codegen->funcs, func );
          }
          list_next( &k );
@@ -311,7 +324,7 @@ static void clarify_funcs( struct codegen* codegen ) {
    while ( ! list_end( &i ) ) {
       struct func* func = list_data( &i );
       struct func_user* impl = func->impl;
-      if ( func->imported && impl->usage ) {
+      if ( func->imported && impl->reachable ) {
          list_append( &codegen->funcs, list_data( &i ) );
       }
       list_next( &i );
@@ -320,7 +333,8 @@ static void clarify_funcs( struct codegen* codegen ) {
    list_iterate( &codegen->task->library_main->funcs, &i );
    while ( ! list_end( &i ) ) {
       struct func* func = list_data( &i );
-      if ( ! func->hidden ) {
+      struct func_user* impl = func->impl;
+      if ( ! func->hidden && impl->reachable ) {
          list_append( &codegen->funcs, func );
       }
       list_next( &i );
@@ -329,7 +343,8 @@ static void clarify_funcs( struct codegen* codegen ) {
    list_iterate( &codegen->task->library_main->funcs, &i );
    while ( ! list_end( &i ) ) {
       struct func* func = list_data( &i );
-      if ( func->hidden ) {
+      struct func_user* impl = func->impl;
+      if ( func->hidden && impl->reachable ) {
          list_append( &codegen->funcs, func );
       }
       list_next( &i );
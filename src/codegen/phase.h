@@ -32,7 +32,10 @@ struct func_record {
    int start_index;
    int array_index;
    int size;
+   // Estimated growth of the code from the calls inlined so far.
+   int inline_growth;
    bool nested_func;
+   bool inlined;
 };
 
 enum {
@@ -80,10 +83,11 @@ struct codegen {
    struct c_node* node;
    struct c_node* node_head;
    struct c_node* node_tail;
-   struct c_node* free_nodes[ C_NODE_TOTAL ];
+   struct c_node_chunk* node_chunks;
+   struct c_node_chunk* node_chunk;
+   struct c_node** patch_nodes;
+   int patch_capacity;
    struct c_pcode* pcode;
-   struct c_pcode_arg* pcodearg_tail;
-   struct c_pcode_arg* free_pcode_args;
    struct indexed_string* assert_prefix;
    int runtime_index;
    struct list used_strings;
@@ -106,6 +110,21 @@ struct codegen {
       bool dim_counter_var;
       bool used;
    } shary;
+   // Number of rewrites done by the optimizer.
+   struct {
+      int dups;
+      int dropped_pushes;
+      int swaps;
+      int negations;
+      int folds;
+      int identities;
+      int shifts;
+      int gotos;
+      int threaded_jumps;
+      int dead_nodes;
+      int packed_slots;
+      int inlined_calls;
+   } optimize_stats;
    struct func* null_handler;
    int object_size;
    int lang;
@@ -170,6 +189,14 @@ struct c_sortedcasejump* c_create_sortedcasejump( struct codegen* codegen );
 void c_append_casejump( struct c_sortedcasejump* sorted_jump,
    struct c_casejump* jump );
 void c_flush_pcode( struct codegen* codegen );
+void c_optimize_pcode( struct codegen* codegen );
+void c_print_optimize_stats( struct codegen* codegen );
+int c_pack_local_vars( struct codegen* codegen, int start, int size );
+bool c_find_live_slots( struct c_node* head, int start, int size,
+   struct list* points, bool* live );
+bool c_is_inlinable_func( struct func* func );
+bool c_fits_inline_budget( struct codegen* codegen, struct func* func );
+void c_write_inline_func( struct codegen* codegen, struct func* func );
 void p_visit_inline_asm( struct codegen* codegen,
    struct inline_asm* inline_asm );
 void c_write_opc( struct codegen* codegen, int opcode );
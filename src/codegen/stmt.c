@@ -1,3 +1,5 @@
+#include <string.h>
+
 #include "phase.h"
 #include "pcode.h"
 
@@ -15,12 +17,27 @@ static void push_if_cond( struct codegen* codegen, struct heavy_cond* cond );
 static void visit_switch( struct codegen* codegen, struct switch_stmt* );
 static void write_switch_casegoto( struct codegen* codegen,
    struct switch_stmt* stmt );
+static void write_case_chain( struct codegen* codegen,
+   struct case_label** cases, int count, struct c_point* default_point );
+static bool search_cases( struct codegen* codegen, struct switch_stmt* stmt );
+static void write_case_search( struct codegen* codegen,
+   struct case_label** cases, int count, int temp,
+   struct c_point* default_point );
+static int case_chain_cost( int count );
+static int case_search_cost( int count );
+static int case_split_cost( int count );
+static bool split_cases( int count );
 static bool string_switch( struct switch_stmt* stmt );
 static void write_switch( struct codegen* codegen, struct switch_stmt* stmt );
 static void write_switch_cond( struct codegen* codegen,
    struct switch_stmt* stmt );
 static void write_string_switch( struct codegen* codegen,
    struct switch_stmt* stmt );
+static void write_string_case_chain( struct codegen* codegen,
+   struct case_label** cases, int count, struct c_point* default_point );
+static void write_string_case_search( struct codegen* codegen,
+   struct case_label** cases, int count, struct c_point* default_point );
+static int compare_string_cases( void* context, void* a, void* b );
 static void visit_case( struct codegen* codegen, struct case_label* );
 static void visit_while( struct codegen* codegen, struct while_stmt* );
 static void write_folded_while( struct codegen* codegen,
@@ -300,26 +317,45 @@ static void visit_switch( struct codegen* codegen, struct switch_stmt* stmt ) {
 static void write_switch_casegoto( struct codegen* codegen,
    struct switch_stmt* stmt ) {
    struct c_point* exit_point = c_create_point( codegen );
+   for ( int i = 0; i < stmt->num_cases; ++i ) {
+      stmt->cases[ i ]->point = c_create_point( codegen );
+   }
+   struct c_point* default_point = exit_point;
+   if ( stmt->case_default ) {
+      default_point = c_create_point( codegen );
+      stmt->case_default->point = default_point;
+   }
    // Condition.
    c_push_expr( codegen, stmt->cond.expr );
    // Case selection.
+   if ( search_cases( codegen, stmt ) ) {
+      int temp = c_alloc_script_var( codegen );
+      c_pcd( codegen, PCD_ASSIGNSCRIPTVAR, temp );
+      write_case_search( codegen, stmt->cases, stmt->num_cases, temp,
+         default_point );
+      c_dealloc_last_script_var( codegen );
+   }
+   else {
+      write_case_chain( codegen, stmt->cases, stmt->num_cases,
+         default_point );
+   }
+   // Body.
+   c_write_stmt( codegen, stmt->body );
+   c_append_node( codegen, &exit_point->node );
+   set_jumps_point( codegen, stmt->jump_break, exit_point );
+}
+
+// Compares the value on the stack against each case in turn.
+static void write_case_chain( struct codegen* codegen,
+   struct case_label** cases, int count, struct c_point* default_point ) {
    bool zero_value_case = false;
-   struct case_label* label = stmt->case_head;
-   while ( label ) {
-      label->point = c_create_point( codegen );
+   for ( int i = 0; i < count; ++i ) {
       struct c_casejump* jump = c_create_casejump( codegen,
-         label->number->value, label->point );
+         cases[ i ]->number->value, cases[ i ]->point );
       c_append_node( codegen, &jump->node );
-      if ( label->number->value == 0 ) {
+      if ( cases[ i ]->number->value == 0 ) {
          zero_value_case = true;
       }
-      label = label->next;
-   }
-   // Default case.
-   struct c_point* default_point = exit_point;
-   if ( stmt->case_default ) {
-      default_point = c_create_point( codegen );
-      stmt->case_default->point = default_point;
    }
    // Optimization: instead of using PCD_DROP and PCD_GOTO to jump to the
    // default point, use a single instruction to eat up the value and jump.
@@ -334,10 +370,70 @@ static void write_switch_casegoto( struct codegen* codegen,
       c_append_node( codegen, &default_jump->node );
       default_jump->point = default_point;
    }
-   // Body.
-   c_write_stmt( codegen, stmt->body );
-   c_append_node( codegen, &exit_point->node );
-   set_jumps_point( codegen, stmt->jump_break, exit_point );
+}
+
+// ACS95 has neither PCD_CASEGOTOSORTED nor a computed jump, so a long chain
+// of PCD_CASEGOTO is the only single-pass dispatch. When optimizing, a long
+// chain is replaced by a binary search over the sorted cases that ends in
+// short chains. The condition is kept in a temporary variable, since ACS95
+// has no PCD_DUP either.
+static bool search_cases( struct codegen* codegen, struct switch_stmt* stmt ) {
+   return ( codegen->task->options->optimize >= OPTIMIZE_BASIC &&
+      // Saving the condition costs one instruction.
+      2 + case_search_cost( stmt->num_cases ) <
+      case_chain_cost( stmt->num_cases ) );
+}
+
+static void write_case_search( struct codegen* codegen,
+   struct case_label** cases, int count, int temp,
+   struct c_point* default_point ) {
+   c_pcd( codegen, PCD_PUSHSCRIPTVAR, temp );
+   if ( ! split_cases( count ) ) {
+      write_case_chain( codegen, cases, count, default_point );
+      return;
+   }
+   // Values less than the middle case are handled by the lower half.
+   int middle = count / 2;
+   c_pcd( codegen, PCD_PUSHNUMBER, cases[ middle ]->number->value );
+   c_pcd( codegen, PCD_LT );
+   struct c_jump* lower_jump = c_create_jump( codegen, PCD_IFGOTO );
+   c_append_node( codegen, &lower_jump->node );
+   write_case_search( codegen, cases + middle, count - middle, temp,
+      default_point );
+   struct c_point* lower_point = c_create_point( codegen );
+   c_append_node( codegen, &lower_point->node );
+   lower_jump->point = lower_point;
+   write_case_search( codegen, cases, middle, temp, default_point );
+}
+
+// The costs are the average number of instructions executed to reach a
+// case, counted in halves.
+static int case_chain_cost( int count ) {
+   return count + 1;
+}
+
+static int case_search_cost( int count ) {
+   int cost = case_chain_cost( count );
+   if ( count >= 2 ) {
+      int split_cost = case_split_cost( count );
+      if ( split_cost < cost ) {
+         cost = split_cost;
+      }
+   }
+   // Loading the condition.
+   return 2 + cost;
+}
+
+// Comparing against the middle case, then searching one of the halves.
+static int case_split_cost( int count ) {
+   int middle = count / 2;
+   return 6 + ( case_search_cost( middle ) +
+      case_search_cost( count - middle ) ) / 2;
+}
+
+static bool split_cases( int count ) {
+   return ( count >= 2 &&
+      case_split_cost( count ) < case_chain_cost( count ) );
 }
 
 inline static bool string_switch( struct switch_stmt* stmt ) {
@@ -355,13 +451,12 @@ static void write_switch( struct codegen* codegen, struct switch_stmt* stmt ) {
    write_switch_cond( codegen, stmt );
    struct c_sortedcasejump* sorted_jump = c_create_sortedcasejump( codegen );
    c_append_node( codegen, &sorted_jump->node );
-   struct case_label* label = stmt->case_head;
-   while ( label ) {
+   for ( int i = 0; i < stmt->num_cases; ++i ) {
+      struct case_label* label = stmt->cases[ i ];
       label->point = c_create_point( codegen );
       struct c_casejump* jump = c_create_casejump( codegen,
          label->number->value, label->point );
       c_append_casejump( sorted_jump, jump );
-      label = label->next;
    }
    c_pcd( codegen, PCD_DROP );
    struct c_point* default_point = exit_point;
@@ -395,16 +490,48 @@ static void write_switch_cond( struct codegen* codegen,
    }
 }
 
-// NOTE: Right now, the implementation does a linear search when attempting to
-// find the correct case. A binary search might be possible. 
+// When optimizing, a switch with many cases does a binary search over the
+// cases sorted by their text, so fewer strings are compared at run time.
 static void write_string_switch( struct codegen* codegen,
    struct switch_stmt* stmt ) {
+   enum { SEARCH_MIN_CASES = 8 };
    struct c_point* exit_point = c_create_point( codegen );
+   struct c_point* default_point = exit_point;
+   if ( stmt->case_default ) {
+      default_point = c_create_point( codegen );
+      stmt->case_default->point = default_point;
+   }
    // Case selection.
    write_switch_cond( codegen, stmt );
-   struct case_label* label = stmt->case_head;
-   while ( label ) {
-      if ( label->next ) {
+   if ( codegen->task->options->optimize >= OPTIMIZE_BASIC &&
+      stmt->num_cases >= SEARCH_MIN_CASES ) {
+      struct case_label** cases = mem_alloc( sizeof( *cases ) *
+         stmt->num_cases * 2 );
+      memcpy( cases, stmt->cases, sizeof( *cases ) * stmt->num_cases );
+      sort_ptrs( ( void** ) cases, ( void** ) cases + stmt->num_cases,
+         stmt->num_cases, compare_string_cases, codegen );
+      write_string_case_search( codegen, cases, stmt->num_cases,
+         default_point );
+      mem_free( cases );
+   }
+   else {
+      write_string_case_chain( codegen, stmt->cases, stmt->num_cases,
+         default_point );
+   }
+   // Body.
+   c_write_stmt( codegen, stmt->body );
+   c_append_node( codegen, &exit_point->node );
+   set_jumps_point( codegen, stmt->jump_break, exit_point );
+}
+
+// Compares the condition string on the stack against each case in turn. The
+// string is consumed.
+static void write_string_case_chain( struct codegen* codegen,
+   struct case_label** cases, int count, struct c_point* default_point ) {
+   for ( int i = 0; i < count; ++i ) {
+      struct case_label* label = cases[ i ];
+      bool last_case = ( i + 1 == count );
+      if ( ! last_case ) {
          c_pcd( codegen, PCD_DUP );
       }
       c_push_string( codegen, t_lookup_string( codegen->task,
@@ -412,7 +539,7 @@ static void write_string_switch( struct codegen* codegen,
       c_pcd( codegen, PCD_CALLFUNC, 2, EXTFUNC_STRCMP );
       struct c_jump* next_jump = c_create_jump( codegen, PCD_IFGOTO );
       c_append_node( codegen, &next_jump->node );
-      if ( label->next ) {
+      if ( ! last_case ) {
          // Match.
          c_pcd( codegen, PCD_DROP );
          struct c_jump* jump = c_create_jump( codegen, PCD_GOTO );
@@ -432,25 +559,50 @@ static void write_string_switch( struct codegen* codegen,
          label->point = c_create_point( codegen );
          next_jump->point = label->point;
       }
-      label = label->next;
    }
    // The last case eats up the condition string. If no cases are present, the
    // string needs to be manually dropped.
-   if ( ! stmt->case_head ) {
+   if ( count == 0 ) {
       c_pcd( codegen, PCD_DROP );
    }
-   struct c_point* default_point = exit_point;
-   if ( stmt->case_default ) {
-      default_point = c_create_point( codegen );
-      stmt->case_default->point = default_point;
-   }
    struct c_jump* default_jump = c_create_jump( codegen, PCD_GOTO );
    c_append_node( codegen, &default_jump->node );
    default_jump->point = default_point;
-   // Body.
-   c_write_stmt( codegen, stmt->body );
-   c_append_node( codegen, &exit_point->node );
-   set_jumps_point( codegen, stmt->jump_break, exit_point );
+}
+
+// Narrows the sorted cases down by comparing against the middle case, until
+// few enough are left to compare one by one.
+static void write_string_case_search( struct codegen* codegen,
+   struct case_label** cases, int count, struct c_point* default_point ) {
+   enum { CHAIN_MAX_CASES = 4 };
+   if ( count <= CHAIN_MAX_CASES ) {
+      write_string_case_chain( codegen, cases, count, default_point );
+      return;
+   }
+   int middle = count / 2;
+   c_pcd( codegen, PCD_DUP );
+   c_push_string( codegen, t_lookup_string( codegen->task,
+      cases[ middle ]->number->value ) );
+   c_pcd( codegen, PCD_CALLFUNC, 2, EXTFUNC_STRCMP );
+   c_pcd( codegen, PCD_PUSHNUMBER, 0 );
+   c_pcd( codegen, PCD_LT );
+   struct c_jump* lower_jump = c_create_jump( codegen, PCD_IFGOTO );
+   c_append_node( codegen, &lower_jump->node );
+   write_string_case_search( codegen, cases + middle, count - middle,
+      default_point );
+   struct c_point* lower_point = c_create_point( codegen );
+   c_append_node( codegen, &lower_point->node );
+   lower_jump->point = lower_point;
+   write_string_case_search( codegen, cases, middle, default_point );
+}
+
+// Orders the strings the same way as the run-time StrCmp() function.
+static int compare_string_cases( void* context, void* a, void* b ) {
+   struct codegen* codegen = context;
+   return strcmp( t_lookup_string( codegen->task,
+      ( ( struct case_label* ) a )->number->value )->value,
+      t_lookup_string( codegen->task,
+      ( ( struct case_label* ) b )->number->value )->value );
 }
 
 static void visit_case( struct codegen* codegen, struct case_label* label ) {
@@ -1121,7 +1273,7 @@ static void visit_return( struct codegen* codegen, struct return_stmt* stmt ) {
       }
    }
    // Exit.
-   if ( codegen->func->nested_func ) {
+   if ( codegen->func->nested_func || codegen->func->inlined ) {
       struct c_jump* epilogue_jump = c_create_jump( codegen, PCD_GOTO );
       c_append_node( codegen, &epilogue_jump->node );
       stmt->epilogue_jump = epilogue_jump;
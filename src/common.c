@@ -499,6 +499,42 @@ int alignpad( int size, int align_size ) {
    }
 }
 
+// Stable merge sort. `temp` needs room for `count` items. The comparison
+// function returns a negative number when `a` goes before `b`.
+void sort_ptrs( void** items, void** temp, int count,
+   int ( *compare )( void* context, void* a, void* b ), void* context ) {
+   for ( int width = 1; width < count; width *= 2 ) {
+      for ( int left = 0; left < count - width; left += width * 2 ) {
+         int middle = left + width;
+         int right = middle + width;
+         if ( right > count ) {
+            right = count;
+         }
+         int i = left;
+         int k = middle;
+         int size = 0;
+         while ( i < middle && k < right ) {
+            if ( compare( context, items[ k ], items[ i ] ) < 0 ) {
+               temp[ size ] = items[ k ];
+               ++k;
+            }
+            else {
+               temp[ size ] = items[ i ];
+               ++i;
+            }
+            ++size;
+         }
+         while ( i < middle ) {
+            temp[ size ] = items[ i ];
+            ++i;
+            ++size;
+         }
+         // The remaining items of the right half are already in place.
+         memcpy( items + left, temp, sizeof( *temp ) * size );
+      }
+   }
+}
+
 #if OS_WINDOWS
 
 bool c_read_full_path( const char* path, struct str* str ) {
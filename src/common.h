@@ -107,6 +107,13 @@ void list_deinit( struct list* list );
 
 // --------------------------------------------------------------------------
 
+enum {
+   OPTIMIZE_NONE,
+   OPTIMIZE_BASIC,
+   OPTIMIZE_INLINE,
+   OPTIMIZE_MAX = OPTIMIZE_INLINE
+};
+
 struct options {
    struct list includes;
    struct list defines;
@@ -115,6 +122,7 @@ struct options {
    const char* object_file;
    int tab_size;
    int lang;
+   int optimize;
    bool acc_err;
    bool acc_stats;
    bool one_column;
@@ -126,6 +134,7 @@ struct options {
    bool legacy_ns_dot;
    bool legacy_array_length_func;
    bool legacy_str_length_func;
+   bool optimize_stats;
    struct {
       const char* dir_path;
       int lifetime;
@@ -206,6 +215,9 @@ const char* c_get_file_ext( const char* path );
 
 int alignpad( int size, int align_size );
 
+void sort_ptrs( void** items, void** temp, int count,
+   int ( *compare )( void* context, void* a, void* b ), void* context );
+
 void fs_init_query( struct fs_query* query, const char* path );
 bool fs_exists( struct fs_query* query );
 bool fs_is_dir( struct fs_query* query );
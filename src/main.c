@@ -116,6 +116,7 @@ static void init_options( struct options* options ) {
    // Default tab size for now is 4, since it's a common indentation size.
    options->tab_size = 4;
    options->lang = LANG_ACS;
+   options->optimize = OPTIMIZE_NONE;
    options->acc_err = false;
    options->acc_stats = false;
    options->one_column = false;
@@ -127,6 +128,7 @@ static void init_options( struct options* options ) {
    options->legacy_ns_dot = false;
    options->legacy_array_length_func = false;
    options->legacy_str_length_func = false;
+   options->optimize_stats = false;
    options->cache.dir_path = NULL;
    options->cache.lifetime = -1;
    options->cache.enable = false;
@@ -198,6 +200,27 @@ static bool read_options( struct options* options, char** argv ) {
             return false;
          }
       }
+      else if ( strcmp( option, "O" ) == 0 ) {
+         if ( *args ) {
+            int level = atoi( *args );
+            if ( level >= OPTIMIZE_NONE && level <= OPTIMIZE_MAX ) {
+               options->optimize = level;
+               ++args;
+            }
+            else {
+               printf( "error: optimization level not between %d and %d\n",
+                  OPTIMIZE_NONE, OPTIMIZE_MAX );
+               return false;
+            }
+         }
+         else {
+            printf( "error: missing optimization level\n" );
+            return false;
+         }
+      }
+      else if ( strcmp( option, "opt-stats" ) == 0 ) {
+         options->optimize_stats = true;
+      }
       else if ( strcmp( option, "one-column" ) == 0 ) {
          options->one_column = true;
       }
@@ -357,6 +380,17 @@ static void print_usage( char* path ) {
       "  -tab-size <size>     Specify the width of the tab character\n"
       "  -strip-asserts       Do not include asserts in object file\n"
       "                       (asserts will not be executed at run-time)\n"
+      "  -O <level>           Optimize the generated code. Level 0, the\n"
+      "                       default, disables optimization; level 1\n"
+      "                       enables the peephole optimizer, replaces\n"
+      "                       reads of never-written map variables with\n"
+      "                       their values, evaluates calls to pure\n"
+      "                       functions with constant arguments, and\n"
+      "                       drops unreachable functions and variables;\n"
+      "                       level 2 also inlines calls to small\n"
+      "                       functions\n"
+      "  -opt-stats           Show how many times each optimization was\n"
+      "                       applied\n"
       "  -legacy-ns-dot       Do not show any deprecation warnings for using\n"
       "                       the `.` operator on namespaces\n"
       "  -legacy-array...\n"
@@ -477,6 +511,9 @@ static void compile_mainlib( struct task* task, struct cache* cache ) {
    if ( task->options->acc_stats ) {
       print_acc_stats( task, &parse, &codegen );
    }
+   if ( task->options->optimize_stats ) {
+      c_print_optimize_stats( &codegen );
+   }
 }
 
 static void print_acc_stats( struct task* task, struct parse* parse,
@@ -90,6 +90,7 @@ static void read_arg( struct parse* parse, struct inline_asm* inline_asm ) {
    else if ( parse->tk == TK_ID ) {
       arg->type = INLINE_ASM_ARG_ID;
       arg->value.id = parse->tk_text;
+      arg->atom = parse->tk_atom;
       p_read_tk( parse );
    }
    else {
@@ -109,6 +110,7 @@ static struct inline_asm_arg* alloc_inline_asm_arg( struct pos* pos ) {
    struct inline_asm_arg* arg = mem_alloc( sizeof( *arg ) );
    arg->type = INLINE_ASM_ARG_NUMBER;
    arg->value.number = 0;
+   arg->atom = NULL;
    arg->pos = *pos;
    return arg;
 }
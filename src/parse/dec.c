@@ -407,7 +407,7 @@ static void read_symbolic_constant( struct parse* parse, struct dec* dec ) {
    p_test_tk( parse, TK_ID );
    struct constant* constant = t_alloc_constant();
    constant->object.pos = parse->tk_pos;
-   constant->name = t_extend_name( parse->ns->body, parse->tk_text );
+   constant->name = t_extend_name_atom( parse->ns->body, parse->tk_atom );
    p_read_tk( parse );
    p_test_tk( parse, TK_ASSIGN );
    p_read_tk( parse );
@@ -497,13 +497,13 @@ static void read_enum_def( struct parse* parse, struct dec* dec ) {
 static void read_enum_name( struct parse* parse, struct dec* dec,
    struct enumeration* enumeration ) {
    if ( parse->tk == TK_ID || parse->tk == TK_TYPENAME ) {
-      enumeration->name = t_extend_name( parse->ns->body_enums,
-         parse->tk_text );
+      enumeration->name = t_extend_name_atom( parse->ns->body_enums,
+         parse->tk_atom );
       enumeration->body = t_extend_name( enumeration->name, "." );
       enumeration->object.pos = parse->tk_pos;
       if ( parse->tk == TK_TYPENAME ) {
          dec->implicit_type_alias.name =
-            t_extend_name( parse->ns->body, parse->tk_text );
+            t_extend_name_atom( parse->ns->body, parse->tk_atom );
          dec->implicit_type_alias.specified = true;
       }
       p_read_tk( parse );
@@ -571,7 +571,7 @@ static void read_enumerator( struct parse* parse,
    }
    struct enumerator* enumerator = t_alloc_enumerator();
    enumerator->object.pos = parse->tk_pos;
-   enumerator->name = t_extend_name( parse->ns->body, parse->tk_text );
+   enumerator->name = t_extend_name_atom( parse->ns->body, parse->tk_atom );
    enumerator->enumeration = enumeration;
    p_read_tk( parse );
    if ( parse->tk == TK_ASSIGN ) {
@@ -664,12 +664,12 @@ static void read_struct_def( struct parse* parse, struct dec* dec ) {
 static void read_struct_name( struct parse* parse, struct dec* dec,
    struct structure* structure ) {
    if ( parse->tk == TK_ID || parse->tk == TK_TYPENAME ) {
-      structure->name = t_extend_name( parse->ns->body_structs,
-         parse->tk_text );
+      structure->name = t_extend_name_atom( parse->ns->body_structs,
+         parse->tk_atom );
       structure->object.pos = parse->tk_pos;
       if ( parse->tk == TK_TYPENAME ) {
          dec->implicit_type_alias.name =
-            t_extend_name( parse->ns->body, parse->tk_text );
+            t_extend_name_atom( parse->ns->body, parse->tk_atom );
          dec->implicit_type_alias.specified = true;
       }
       p_read_tk( parse );
@@ -1332,7 +1332,7 @@ static void read_storage_index( struct parse* parse, struct dec* dec ) {
 
 static void read_name( struct parse* parse, struct dec* dec ) {
    if ( is_name( parse, dec ) ) {
-      dec->name = t_extend_name( dec->name_offset, parse->tk_text );
+      dec->name = t_extend_name_atom( dec->name_offset, parse->tk_atom );
       dec->name_pos = parse->tk_pos;
       p_read_tk( parse );
    }
@@ -2228,7 +2228,7 @@ static void read_param_name( struct parse* parse, struct param* param ) {
          p_unexpect_last_name( parse, NULL, "parameter name" );
          p_bail( parse );
       }
-      param->name = t_extend_name( parse->ns->body, parse->tk_text );
+      param->name = t_extend_name_atom( parse->ns->body, parse->tk_atom );
       param->object.pos = parse->tk_pos;
       p_read_tk( parse );
    }
@@ -2460,7 +2460,7 @@ static void read_script_param( struct parse* parse,
       parse->lang == LANG_BCS &&
       parse->tk != TK_ID ) ) {
       p_test_tk( parse, TK_ID );
-      param->name = t_extend_name( parse->ns->body, parse->tk_text );
+      param->name = t_extend_name_atom( parse->ns->body, parse->tk_atom );
       param->object.pos = parse->tk_pos;
       p_read_tk( parse );
    }
@@ -2733,7 +2733,7 @@ static void read_special( struct parse* parse ) {
    // Name.
    p_test_tk( parse, TK_ID );
    func->object.pos = parse->tk_pos;
-   func->name = t_extend_name( parse->ns->body, parse->tk_text );
+   func->name = t_extend_name_atom( parse->ns->body, parse->tk_atom );
    p_read_tk( parse );
    // Parameters.
    p_test_tk( parse, TK_PAREN_L );
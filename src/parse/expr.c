@@ -41,7 +41,7 @@ static void read_suffix( struct parse* parse, struct expr_reading* reading );
 static void read_subscript( struct parse* parse,
    struct expr_reading* reading );
 static void read_access( struct parse* parse, struct expr_reading* reading );
-static struct access* alloc_access( const char* name, struct pos pos );
+static struct access* alloc_access( struct atom* name, struct pos pos );
 static void read_post_inc( struct parse* parse, struct expr_reading* reading );
 static void read_call( struct parse* parse, struct expr_reading* reading );
 static void read_call_args( struct parse* parse, struct expr_reading* reading,
@@ -418,6 +418,7 @@ static struct logical* alloc_logical( int op, struct pos* pos ) {
    logical->rside_spec = SPEC_NONE;
    logical->value = 0;
    logical->folded = false;
+   logical->rside_changes_refs = false;
    return logical;
 }
 
@@ -635,8 +636,10 @@ static void read_name_usage( struct parse* parse,
    struct name_usage* usage = mem_slot_alloc( sizeof( *usage ) );
    usage->node.type = NODE_NAME_USAGE;
    usage->text = parse->tk_text;
+   usage->atom = parse->tk_atom;
    usage->pos = parse->tk_pos;
    usage->object = NULL;
+   usage->non_null = false;
    reading->node = &usage->node;
    p_read_tk( parse );
 }
@@ -974,6 +977,8 @@ static void read_subscript( struct parse* parse,
    p_read_tk( parse );
    subscript->index = index.output_node;
    subscript->lside = reading->node;
+   subscript->var = NULL;
+   subscript->offset = 0;
    subscript->string = false;
    reading->node = &subscript->node;
 }
@@ -982,16 +987,17 @@ static void read_access( struct parse* parse, struct expr_reading* reading ) {
    struct pos pos = parse->tk_pos;
    p_read_tk( parse );
    p_test_tk( parse, TK_ID );
-   struct access* access = alloc_access( parse->tk_text, pos );
+   struct access* access = alloc_access( parse->tk_atom, pos );
    access->lside = reading->node;
    reading->node = &access->node;
    p_read_tk( parse );
 }
 
-static struct access* alloc_access( const char* name, struct pos pos ) {
+static struct access* alloc_access( struct atom* name, struct pos pos ) {
    struct access* access = mem_alloc( sizeof( *access ) );
    access->node.type = NODE_ACCESS;
-   access->name = name;
+   access->name = name->text;
+   access->atom = name;
    access->pos = pos;
    access->lside = NULL;
    access->rside = NULL;
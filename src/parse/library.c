@@ -206,7 +206,7 @@ static void read_namespace_name( struct parse* parse ) {
       struct ns* ns = parse->ns;
       struct ns_path* path = parse->ns_fragment->path;
       while ( path ) {
-         struct name* name = t_extend_name( ns->body, path->text );
+         struct name* name = t_extend_name_atom( ns->body, path->atom );
          if ( name->object ) {
             // Object must be a namespace.
             if ( name->object->node.type != NODE_NAMESPACE ) {
@@ -259,6 +259,7 @@ static void read_namespace_path( struct parse* parse ) {
    struct ns_path* tail = head;
    head->next = NULL;
    head->text = parse->tk_text;
+   head->atom = parse->tk_atom;
    head->pos = parse->tk_pos;
    head->dot_separator = false;
    p_read_tk( parse );
@@ -269,6 +270,7 @@ static void read_namespace_path( struct parse* parse ) {
       struct ns_path* path = mem_alloc( sizeof( *head ) );
       path->next = NULL;
       path->text = parse->tk_text;
+      path->atom = parse->tk_atom;
       path->pos = parse->tk_pos;
       path->dot_separator = ( separator == TK_DOT );
       tail->next = path;
@@ -415,6 +417,7 @@ static struct using_dirc* alloc_using( struct pos* pos ) {
 static void read_using_item( struct parse* parse, struct using_dirc* dirc ) {
    struct using_item* item = alloc_using_item();
    item->name = parse->tk_text;
+   item->atom = parse->tk_atom;
    item->pos = parse->tk_pos;
    bool type_alias = false;
    switch ( parse->tk ) {
@@ -424,6 +427,7 @@ static void read_using_item( struct parse* parse, struct using_dirc* dirc ) {
          p_test_tk( parse, TK_ID );
       }
       item->name = parse->tk_text;
+      item->atom = parse->tk_atom;
       item->type = USINGITEM_STRUCT;
       p_read_tk( parse );
       break;
@@ -433,6 +437,7 @@ static void read_using_item( struct parse* parse, struct using_dirc* dirc ) {
          p_test_tk( parse, TK_ID );
       }
       item->name = parse->tk_text;
+      item->atom = parse->tk_atom;
       item->type = USINGITEM_ENUM;
       p_read_tk( parse );
       break;
@@ -445,6 +450,7 @@ static void read_using_item( struct parse* parse, struct using_dirc* dirc ) {
       p_read_tk( parse );
    }
    item->usage_name = item->name;
+   item->usage_atom = item->atom;
    if ( parse->tk == TK_ASSIGN ) {
       p_read_tk( parse );
       if ( type_alias ) {
@@ -461,6 +467,7 @@ static void read_using_item( struct parse* parse, struct using_dirc* dirc ) {
          p_test_tk( parse, TK_ID );
       }
       item->name = parse->tk_text;
+      item->atom = parse->tk_atom;
       p_read_tk( parse );
    }
    list_append( &dirc->items, item );
@@ -470,6 +477,8 @@ static struct using_item* alloc_using_item( void ) {
    struct using_item* item = mem_alloc( sizeof( *item ) );
    item->name = NULL;
    item->usage_name = NULL;
+   item->atom = NULL;
+   item->usage_atom = NULL;
    item->alias = NULL;
    t_init_pos_id( &item->pos, INTERNALFILE_COMPILER );
    item->type = USINGITEM_OBJECT;
@@ -492,6 +501,7 @@ struct path* p_read_path( struct parse* parse ) {
    else {
       p_test_tk( parse, TK_ID );
       path->text = parse->tk_text;
+      path->atom = parse->tk_atom;
       p_read_tk( parse );
    }
    // Separator of path components can be either `::` or `.`. The separator
@@ -505,6 +515,7 @@ struct path* p_read_path( struct parse* parse ) {
       p_test_tk( parse, TK_ID );
       path = alloc_path( parse->tk_pos );
       path->text = parse->tk_text;
+      path->atom = parse->tk_atom;
       path->dot_separator = ( separator == TK_DOT );
       tail->next = path;
       tail = path;
@@ -517,6 +528,7 @@ static struct path* alloc_path( struct pos pos ) {
    struct path* path = mem_alloc( sizeof( *path ) );
    path->next = NULL;
    path->text = "";
+   path->atom = NULL;
    path->pos = pos;
    path->upmost = false;
    path->current_ns = false;
@@ -591,6 +603,7 @@ struct path* p_read_type_path( struct parse* parse ) {
    if ( parse->tk == TK_TYPENAME ) {
       struct path* path = alloc_path( parse->tk_pos );
       path->text = parse->tk_text;
+      path->atom = parse->tk_atom;
       p_read_tk( parse );
       return path;
    }
@@ -608,6 +621,7 @@ struct path* p_read_type_path( struct parse* parse ) {
       else {
          p_test_tk( parse, TK_ID );
          path->text = parse->tk_text;
+         path->atom = parse->tk_atom;
          p_read_tk( parse );
       }
       // Middle.
@@ -621,6 +635,7 @@ struct path* p_read_type_path( struct parse* parse ) {
          p_test_tk( parse, TK_ID );
          path = alloc_path( parse->tk_pos );
          path->text = parse->tk_text;
+         path->atom = parse->tk_atom;
          path->dot_separator = ( separator == TK_DOT );
          tail->next = path;
          tail = path;
@@ -632,6 +647,7 @@ struct path* p_read_type_path( struct parse* parse ) {
       p_test_tk( parse, TK_TYPENAME );
       path = alloc_path( parse->tk_pos );
       path->text = parse->tk_text;
+      path->atom = parse->tk_atom;
       path->dot_separator = ( separator == TK_DOT );
       tail->next = path;
       p_read_tk( parse );
@@ -801,7 +817,7 @@ static void read_define( struct parse* parse ) {
    p_test_tk( parse, TK_ID );
    struct constant* constant = t_alloc_constant();
    constant->object.pos = parse->tk_pos;
-   constant->name = t_extend_name( parse->ns->body, parse->tk_text );
+   constant->name = t_extend_name_atom( parse->ns->body, parse->tk_atom );
    p_read_tk( parse );
    struct expr_reading value;
    p_init_expr_reading( &value, true, false, false, true );
@@ -18,12 +18,15 @@ void p_init( struct parse* parse, struct task* task, struct cache* cache ) {
    str_init( &parse->token_presentation );
    parse->read_flags = READF_CONCATSTRINGS | READF_ESCAPESEQ;
    parse->concat_strings = false;
-   parse->macro_head = NULL;
+   parse->macros.buckets = NULL;
+   parse->macros.capacity = 0;
+   parse->macros.size = 0;
    parse->macro_free = NULL;
    parse->macro_param_free = NULL;
    parse->macro_expan = NULL;
    parse->macro_expan_free = NULL;
    parse->macro_arg_free = NULL;
+   parse->defined_atom = t_intern_atom( "defined", strlen( "defined" ) );
    parse->ifdirc = NULL;
    parse->ifdirc_free = NULL;
 
@@ -202,6 +202,9 @@ struct token {
    // text will be NULL and the length will be zero.
    char* modifiable_text;
    const char* text;
+   // Interned text of an identifier. For the rest of the tokens, the atom
+   // will be NULL.
+   struct atom* atom;
    struct pos pos;
    enum tk type;
    int length;
@@ -225,8 +228,17 @@ struct token_info {
    unsigned int flags;
 };
 
+// Maps a reserved identifier to its token. The atom is filled in on the first
+// lookup.
+struct keyword {
+   const char* name;
+   enum tk tk;
+   struct atom* atom;
+};
+
 struct macro {
    const char* name;
+   struct atom* atom;
    struct macro* next;
    struct macro_param* param_head;
    struct macro_param* param_tail;
@@ -249,6 +261,7 @@ struct macro {
 
 struct macro_param {
    const char* name;
+   struct atom* atom;
    struct macro_param* next;
 };
 
@@ -370,6 +383,7 @@ struct parse {
    enum tk tk;
    struct pos tk_pos;
    const char* tk_text;
+   struct atom* tk_atom;
    int tk_length;
    struct source* source;
    struct source* free_source;
@@ -386,12 +400,19 @@ struct parse {
       READF_SPACETAB = 0x8,
    } read_flags;
    bool concat_strings;
-   struct macro* macro_head;
+   // Defined macros, hashed by the atom of the macro name.
+   struct {
+      struct macro** buckets;
+      int capacity;
+      int size;
+   } macros;
    struct macro* macro_free;
    struct macro_param* macro_param_free;
    struct macro_expan* macro_expan;
    struct macro_expan* macro_expan_free;
    struct macro_arg* macro_arg_free;
+   // Atom of the reserved `defined` macro name.
+   struct atom* defined_atom;
    struct ifdirc* ifdirc;
    struct ifdirc* ifdirc_free;
 
@@ -495,10 +516,11 @@ void p_deinit_tk( struct parse* parse );
 void p_read_source( struct parse* parse, struct token* token );
 bool p_read_dirc( struct parse* parse );
 void p_confirm_ifdircs_closed( struct parse* parse );
-struct macro* p_find_macro( struct parse* parse, const char* name );
+struct macro* p_find_macro( struct parse* parse, struct atom* name );
 bool p_read_dirc( struct parse* parse );
 int p_eval_prep_expr( struct parse* parse );
 const struct token_info* p_get_token_info( enum tk tk );
+enum tk p_find_keyword( struct keyword* table, int size, struct atom* atom );
 struct token* p_alloc_token( struct parse* parse );
 void p_free_token( struct parse* parse, struct token* token );
 void p_init_parsertk_iter( struct parse* parse, struct parsertk_iter* iter );
@@ -527,7 +549,7 @@ void p_define_cmdline_macros( struct parse* parse );
 void p_undefine_included_macro( struct parse* parse );
 void p_read_func_body( struct parse* parse, struct func* func );
 int p_determine_lang_from_file_path( const char* path );
-bool p_is_macro_defined( struct parse* parse, const char* name );
+bool p_is_macro_defined( struct parse* parse, struct atom* name );
 void p_init_token( struct token* token );
 bool p_source_has_data( struct parse* parse );
 void p_pop_source( struct parse* parse );
@@ -50,7 +50,7 @@ static struct buildmsg* read_buildmsg( struct parse* parse,
    struct stmt_reading* reading );
 static void read_expr_stmt( struct parse* parse,
    struct stmt_reading* reading );
-static struct label* alloc_label( const char* name, struct pos* pos );
+static struct label* alloc_label( struct atom* name, struct pos* pos );
 static void read_assert( struct parse* parse, struct stmt_reading* reading );
 static struct assert* alloc_assert( struct pos* pos );
 
@@ -271,7 +271,6 @@ static void read_case( struct parse* parse, struct stmt_reading* reading ) {
    struct case_label* label = mem_alloc( sizeof( *label ) );
    label->node.type = NODE_CASE;
    label->offset = 0;
-   label->next = NULL;
    label->point = NULL;
    label->pos = parse->tk_pos;
    p_read_tk( parse );
@@ -297,20 +296,21 @@ static void read_default_case( struct parse* parse,
 }
 
 static void read_label( struct parse* parse, struct stmt_reading* reading ) {
-   struct label* label = alloc_label( parse->tk_text, &parse->tk_pos );
-   list_append( reading->labels, label );
    p_test_tk( parse, TK_ID );
+   struct label* label = alloc_label( parse->tk_atom, &parse->tk_pos );
+   list_append( reading->labels, label );
    p_read_tk( parse );
    p_test_tk( parse, TK_COLON );
    p_read_tk( parse );
    reading->node = &label->node;
 }
 
-static struct label* alloc_label( const char* name, struct pos* pos ) {
+static struct label* alloc_label( struct atom* name, struct pos* pos ) {
    struct label* label = mem_alloc( sizeof( *label ) );
    label->node.type = NODE_GOTO_LABEL;
    label->pos = *pos;
-   label->name = name;
+   label->name = name->text;
+   label->atom = name;
    label->buildmsg = NULL;
    label->point = NULL;
    list_init( &label->users );
@@ -406,8 +406,9 @@ static struct switch_stmt* alloc_switch_stmt( void ) {
    struct switch_stmt* stmt = mem_alloc( sizeof( *stmt ) );
    stmt->node.type = NODE_SWITCH;
    init_heavy_cond( &stmt->cond );
-   stmt->case_head = NULL;
+   stmt->cases = NULL;
    stmt->case_default = NULL;
+   stmt->num_cases = 0;
    stmt->jump_break = NULL;
    stmt->body = NULL;
    return stmt;
@@ -656,6 +657,7 @@ static void read_goto( struct parse* parse, struct stmt_reading* reading ) {
    p_read_tk( parse );
    p_test_tk( parse, TK_ID );
    stmt->label_name = parse->tk_text;
+   stmt->label_atom = parse->tk_atom;
    stmt->label_name_pos = parse->tk_pos;
    p_read_tk( parse );
    p_test_tk( parse, TK_SEMICOLON );
@@ -669,6 +671,7 @@ static struct goto_stmt* alloc_goto_stmt( struct pos* pos ) {
    stmt->obj_pos = 0;
    stmt->label = NULL;
    stmt->label_name = NULL;
+   stmt->label_atom = NULL;
    stmt->pos = *pos;
    t_init_pos_id( &stmt->label_name_pos, INTERNALFILE_COMPILER );
    stmt->buildmsg = NULL;
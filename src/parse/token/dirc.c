@@ -43,13 +43,13 @@ struct endif_search {
 };
 
 static enum dirc identify_dirc( struct parse* parse );
-static enum dirc identify_named_dirc( const char* name );
+static enum dirc identify_named_dirc( struct atom* name );
 static void read_identified_dirc( struct parse* parse, struct pos* pos,
    enum dirc dirc );
 static void read_define( struct parse* parse );
 static void read_macro_name( struct parse* parse,
    struct macro_reading* reading );
-static bool valid_macro_name( const char* name );
+static bool valid_macro_name( struct parse* parse, struct atom* name );
 static struct macro* alloc_macro( struct parse* parse );
 static void read_macro_param_list( struct parse* parse,
    struct macro_reading* reading );
@@ -72,7 +72,10 @@ static void read_include( struct parse* parse );
 static void read_error( struct parse* parse, struct pos* pos );
 static void read_line( struct parse* parse );
 static void read_undef( struct parse* parse );
-static struct macro* remove_macro( struct parse* parse, const char* name );
+static struct macro* remove_macro( struct parse* parse, struct atom* name );
+static void define_predef_macro( struct parse* parse, const char* name,
+   int predef );
+static void grow_macro_table( struct parse* parse );
 static void read_if( struct parse* parse, struct pos* pos );
 static void push_ifdirc( struct parse* parse, const char* name,
    struct pos* pos );
@@ -114,7 +117,7 @@ static enum dirc identify_dirc( struct parse* parse ) {
    }
    enum dirc dirc = DIRC_NONE;
    if ( iter.token->type == TK_ID ) {
-      dirc = identify_named_dirc( iter.token->text );
+      dirc = identify_named_dirc( iter.token->atom );
       // To stay compatible with ACS, only execute the following directives
       // when inside the #if family of directives.
       switch ( dirc ) {
@@ -134,29 +137,36 @@ static enum dirc identify_dirc( struct parse* parse ) {
    return dirc;
 }
 
-static enum dirc identify_named_dirc( const char* name ) {
-   static const struct {
+static enum dirc identify_named_dirc( struct atom* name ) {
+   static struct {
       const char* name;
       int dirc;
+      struct atom* atom;
    } table[] = {
-      { "define", DIRC_DEFINE },
-      { "include", DIRC_INCLUDE },
-      { "ifdef", DIRC_IFDEF },
-      { "ifndef", DIRC_IFNDEF },
-      { "if", DIRC_IF },
-      { "elif", DIRC_ELIF },
-      { "else", DIRC_ELSE },
-      { "endif", DIRC_ENDIF },
-      { "undef", DIRC_UNDEF },
-      { "error", DIRC_ERROR },
-      { "line", DIRC_LINE },
-      { "region", DIRC_REGION },
-      { "endregion", DIRC_ENDREGION },
-      { NULL, DIRC_NONE }
+      { "define", DIRC_DEFINE, NULL },
+      { "include", DIRC_INCLUDE, NULL },
+      { "ifdef", DIRC_IFDEF, NULL },
+      { "ifndef", DIRC_IFNDEF, NULL },
+      { "if", DIRC_IF, NULL },
+      { "elif", DIRC_ELIF, NULL },
+      { "else", DIRC_ELSE, NULL },
+      { "endif", DIRC_ENDIF, NULL },
+      { "undef", DIRC_UNDEF, NULL },
+      { "error", DIRC_ERROR, NULL },
+      { "line", DIRC_LINE, NULL },
+      { "region", DIRC_REGION, NULL },
+      { "endregion", DIRC_ENDREGION, NULL },
+      { NULL, DIRC_NONE, NULL }
    };
+   // Intern the directive names on first use.
+   if ( ! table[ 0 ].atom ) {
+      for ( int i = 0; table[ i ].name; ++i ) {
+         table[ i ].atom = t_intern_atom( table[ i ].name,
+            strlen( table[ i ].name ) );
+      }
+   }
    int i = 0;
-   while ( table[ i ].name &&
-      strcmp( name, table[ i ].name ) != 0 ) {
+   while ( table[ i ].name && table[ i ].atom != name ) {
       ++i;
    }
    return table[ i ].dirc;
@@ -217,21 +227,23 @@ static void read_define( struct parse* parse ) {
 static void read_macro_name( struct parse* parse,
    struct macro_reading* reading ) {
    p_test_preptk( parse, TK_ID );
-   if ( ! valid_macro_name( parse->token->text ) ) {
+   if ( ! valid_macro_name( parse, parse->token->atom ) ) {
       p_diag( parse, DIAG_POS_ERR, &parse->token->pos,
          "invalid macro name" );
       p_bail( parse );
    }
    struct macro* macro = alloc_macro( parse );
    macro->name = parse->token->text;
+   macro->atom = parse->token->atom;
    macro->pos = parse->token->pos;
    reading->macro = macro;
    p_read_stream( parse );
 }
 
-inline static bool valid_macro_name( const char* name ) {
+inline static bool valid_macro_name( struct parse* parse,
+   struct atom* name ) {
    // At this time, only one name is reserved and cannot be used.
-   return ( strcmp( name, "defined" ) != 0 );
+   return ( name != parse->defined_atom );
 }
 
 static struct macro* alloc_macro( struct parse* parse ) {
@@ -244,6 +256,7 @@ static struct macro* alloc_macro( struct parse* parse ) {
       macro = mem_alloc( sizeof( *macro ) );
    }
    macro->name = NULL;
+   macro->atom = NULL;
    macro->next = NULL;
    macro->param_head = NULL;
    macro->param_tail = NULL;
@@ -273,7 +286,7 @@ static void read_param_list( struct parse* parse,
    while ( parse->token->type == TK_ID ) {
       struct macro_param* param = reading->macro->param_head;
       while ( param ) {
-         if ( strcmp( param->name, parse->token->text ) == 0 ) {
+         if ( param->atom == parse->token->atom ) {
             p_diag( parse, DIAG_POS_ERR, &parse->token->pos,
                "duplicate macro parameter" );
             p_bail( parse );
@@ -282,6 +295,7 @@ static void read_param_list( struct parse* parse,
       }
       param = alloc_param( parse );
       param->name = parse->token->text;
+      param->atom = parse->token->atom;
       append_param( reading->macro, param );
       p_read_preptk( parse );
       comma = ( parse->token->type == TK_COMMA );
@@ -302,6 +316,7 @@ static void read_param_list( struct parse* parse,
       ( comma || reading->macro->param_count == 0 ) ) {
       struct macro_param* param = alloc_param( parse );
       param->name = "__VA_ARGS__";
+      param->atom = t_intern_atom( param->name, strlen( param->name ) );
       append_param( reading->macro, param );
       reading->macro->variadic = true;
       parse->variadic_macro_context = true;
@@ -321,6 +336,7 @@ static struct macro_param* alloc_param( struct parse* parse ) {
       param = mem_alloc( sizeof( *param ) );
    }
    param->name = NULL;
+   param->atom = NULL;
    param->next = NULL;
    return param;
 }
@@ -413,9 +429,9 @@ static void read_body_item( struct parse* parse,
       token->length = 1;
    }
    append_token( reading->macro, token );
-   if ( strcmp( token->text, reading->macro->name ) == 0 ) {
+   if ( token->atom == reading->macro->atom ) {
       struct macro_param* param = reading->macro->param_head;
-      while ( param && strcmp( param->name, token->text ) != 0 ) {
+      while ( param && param->atom != token->atom ) {
          param = param->next;
       }
       if ( ! param ) {
@@ -428,7 +444,7 @@ static void read_body_item( struct parse* parse,
 static bool valid_macro_param( struct parse* parse, struct macro* macro ) {
    struct macro_param* param = macro->param_head;
    while ( param && param->name ) {
-      if ( strcmp( parse->token->text, param->name ) == 0 ) {
+      if ( param->atom == parse->token->atom ) {
          return true;
       }
       param = param->next;
@@ -448,7 +464,7 @@ static void append_token( struct macro* macro, struct token* token ) {
 
 static void finish_macro( struct parse* parse,
    struct macro_reading* reading ) {
-   struct macro* prev_macro = p_find_macro( parse, reading->macro->name );
+   struct macro* prev_macro = p_find_macro( parse, reading->macro->atom );
    if ( prev_macro ) {
       if ( ! ( prev_macro->predef == PREDEFMACRO_NONE ) ) {
          p_diag( parse, DIAG_POS_ERR, &reading->macro->pos,
@@ -473,17 +489,13 @@ static void finish_macro( struct parse* parse,
    parse->variadic_macro_context = false;
 }
 
-struct macro* p_find_macro( struct parse* parse, const char* name ) {
-   struct macro* macro = parse->macro_head;
-   while ( macro ) {
-      int result = strcmp( macro->name, name );
-      if ( result == 0 ) {
-         break;
-      }
-      if ( result > 0 ) {
-         macro = NULL;
-         break;
-      }
+struct macro* p_find_macro( struct parse* parse, struct atom* name ) {
+   if ( parse->macros.size == 0 ) {
+      return NULL;
+   }
+   struct macro* macro = parse->macros.buckets[ name->hash &
+      ( parse->macros.capacity - 1 ) ];
+   while ( macro && macro->atom != name ) {
       macro = macro->next;
    }
    return macro;
@@ -499,7 +511,7 @@ static bool same_macro( struct macro* a, struct macro* b ) {
       struct macro_param* param_a = a->param_head;
       struct macro_param* param_b = b->param_head;
       while ( param_a && param_b ) {
-         if ( strcmp( param_a->name, param_b->name ) != 0 ) {
+         if ( param_a->atom != param_b->atom ) {
             return false;
          }
          param_a = param_a->next;
@@ -550,29 +562,53 @@ static void free_macro( struct parse* parse, struct macro* macro ) {
 }
 
 static void append_macro( struct parse* parse, struct macro* macro ) {
-   struct macro* prev = NULL;
-   struct macro* curr = parse->macro_head;
-   while ( curr && strcmp( curr->name, macro->name ) < 0 ) {
-      prev = curr;
-      curr = curr->next;
+   if ( parse->macros.size == parse->macros.capacity ) {
+      grow_macro_table( parse );
+   }
+   struct macro** bucket = &parse->macros.buckets[ macro->atom->hash &
+      ( parse->macros.capacity - 1 ) ];
+   macro->next = *bucket;
+   *bucket = macro;
+   ++parse->macros.size;
+}
+
+static void grow_macro_table( struct parse* parse ) {
+   enum { INITIAL_CAPACITY = 64 };
+   int capacity = ( parse->macros.capacity > 0 ) ?
+      parse->macros.capacity * 2 : INITIAL_CAPACITY;
+   struct macro** buckets = mem_alloc( sizeof( *buckets ) * capacity );
+   for ( int i = 0; i < capacity; ++i ) {
+      buckets[ i ] = NULL;
    }
-   if ( prev ) {
-      macro->next = prev->next;
-      prev->next = macro;
+   for ( int i = 0; i < parse->macros.capacity; ++i ) {
+      struct macro* macro = parse->macros.buckets[ i ];
+      while ( macro ) {
+         struct macro* next = macro->next;
+         struct macro** bucket = &buckets[ macro->atom->hash &
+            ( capacity - 1 ) ];
+         macro->next = *bucket;
+         *bucket = macro;
+         macro = next;
+      }
    }
-   else {
-      macro->next = parse->macro_head;
-      parse->macro_head = macro;
+   if ( parse->macros.buckets ) {
+      mem_free( parse->macros.buckets );
    }
+   parse->macros.buckets = buckets;
+   parse->macros.capacity = capacity;
 }
 
 void p_clear_macros( struct parse* parse ) {
-   struct macro* macro = parse->macro_head;
-   while ( macro ) {
-      parse->macro_head = macro->next;
-      free_macro( parse, macro );
-      macro = parse->macro_head;
+   for ( int i = 0; i < parse->macros.capacity; ++i ) {
+      struct macro* macro = parse->macros.buckets[ i ];
+      while ( macro ) {
+         struct macro* next = macro->next;
+         free_macro( parse, macro );
+         macro = next;
+      }
+      parse->macros.buckets[ i ] = NULL;
    }
+   parse->macros.size = 0;
 }
 
 static void read_include( struct parse* parse ) {
@@ -624,12 +660,12 @@ static void read_undef( struct parse* parse ) {
    p_test_preptk( parse, TK_ID );
    p_read_preptk( parse );
    p_test_preptk( parse, TK_ID );
-   if ( ! valid_macro_name( parse->token->text ) ) {
+   if ( ! valid_macro_name( parse, parse->token->atom ) ) {
       p_diag( parse, DIAG_POS_ERR, &parse->token->pos,
          "invalid macro name", parse->token->text );
       p_bail( parse );
    }
-   struct macro* macro = remove_macro( parse, parse->token->text );
+   struct macro* macro = remove_macro( parse, parse->token->atom );
    if ( macro ) {
       if ( ! ( macro->predef == PREDEFMACRO_NONE ) ) {
          p_diag( parse, DIAG_POS_ERR, &parse->token->pos,
@@ -642,30 +678,19 @@ static void read_undef( struct parse* parse ) {
    p_test_preptk( parse, TK_NL );
 }
 
-static struct macro* remove_macro( struct parse* parse, const char* name ) {
-   struct macro* macro_prev = NULL;
-   struct macro* macro = parse->macro_head;
-   while ( macro ) {
-      int result = strcmp( macro->name, name );
-      if ( result == 0 ) {
-         break;
-      }
-      else if ( result > 0 ) {
-         macro = NULL;
-         break;
-      }
-      else {
-         macro_prev = macro;
-         macro = macro->next;
-      }
+static struct macro* remove_macro( struct parse* parse, struct atom* name ) {
+   if ( parse->macros.size == 0 ) {
+      return NULL;
+   }
+   struct macro** link = &parse->macros.buckets[ name->hash &
+      ( parse->macros.capacity - 1 ) ];
+   while ( *link && ( *link )->atom != name ) {
+      link = &( *link )->next;
    }
+   struct macro* macro = *link;
    if ( macro ) {
-      if ( macro_prev ) {
-         macro_prev->next = macro->next;
-      }
-      else {
-         parse->macro_head = macro->next;
-      }
+      *link = macro->next;
+      --parse->macros.size;
    }
    return macro;
 }
@@ -716,7 +741,7 @@ static void read_ifdef( struct parse* parse, struct pos* pos ) {
    push_ifdirc( parse, parse->token->text, pos );
    p_read_preptk( parse );
    p_test_preptk( parse, TK_ID );
-   bool defined = p_is_macro_defined( parse, parse->token->text );
+   bool defined = p_is_macro_defined( parse, parse->token->atom );
    p_read_preptk( parse );
    p_test_preptk( parse, TK_NL );
    if ( ! (
@@ -726,7 +751,7 @@ static void read_ifdef( struct parse* parse, struct pos* pos ) {
    }
 }
 
-bool p_is_macro_defined( struct parse* parse, const char* name ) {
+bool p_is_macro_defined( struct parse* parse, struct atom* name ) {
    return ( p_find_macro( parse, name ) != NULL );
 }
 
@@ -766,24 +791,28 @@ static void find_endif( struct parse* parse, struct endif_search* search ) {
 
 static void read_search_dirc( struct parse* parse, struct endif_search* search,
    struct pos* pos ) {
-   if ( strcmp( parse->token->text, "ifdef" ) == 0 ||
-      strcmp( parse->token->text, "ifndef" ) == 0 ||
-      strcmp( parse->token->text, "if" ) == 0 ) {
+   switch ( identify_named_dirc( parse->token->atom ) ) {
+   case DIRC_IFDEF:
+   case DIRC_IFNDEF:
+   case DIRC_IF:
       push_ifdirc( parse, parse->token->text, pos );
       ++search->depth;
-   }
-   else if ( strcmp( parse->token->text, "elif" ) == 0 ) {
+      break;
+   case DIRC_ELIF:
       if ( search->depth == 1 ) {
          read_elif( parse, search, pos );
       }
-   }
-   else if ( strcmp( parse->token->text, "else" ) == 0 ) {
+      break;
+   case DIRC_ELSE:
       if ( search->depth == 1 ) {
          read_else( parse, search, pos );
       }
-   }
-   else if ( strcmp( parse->token->text, "endif" ) == 0 ) {
+      break;
+   case DIRC_ENDIF:
       read_endif( parse, search, pos );
+      break;
+   default:
+      break;
    }
 }
 
@@ -869,51 +898,40 @@ void p_confirm_ifdircs_closed( struct parse* parse ) {
 }
 
 void p_define_imported_macro( struct parse* parse ) {
-   struct macro* macro = alloc_macro( parse );
-   macro->name = "__IMPORTED__";
-   macro->predef = PREDEFMACRO_IMPORTED;
-   append_macro( parse, macro );
+   define_predef_macro( parse, "__IMPORTED__", PREDEFMACRO_IMPORTED );
 }
 
 // The predefined __INCLUDED__ macro is present as long as an #included file is
 // being processed. 
 void p_define_included_macro( struct parse* parse ) {
-   struct macro* macro = p_find_macro( parse, "__INCLUDED__" );
+   struct macro* macro = p_find_macro( parse,
+      t_intern_atom( "__INCLUDED__", strlen( "__INCLUDED__" ) ) );
    if ( ! macro ) {
-      macro = alloc_macro( parse );
-      macro->name = "__INCLUDED__";
-      macro->predef = PREDEFMACRO_INCLUDED;
-      append_macro( parse, macro );
+      define_predef_macro( parse, "__INCLUDED__", PREDEFMACRO_INCLUDED );
    }
 }
 
 void p_undefine_included_macro( struct parse* parse ) {
-   struct macro* macro = remove_macro( parse, "__INCLUDED__" );
+   struct macro* macro = remove_macro( parse,
+      t_intern_atom( "__INCLUDED__", strlen( "__INCLUDED__" ) ) );
    if ( macro ) {
       free_macro( parse, macro );
    }
 }
 
 void p_define_predef_macros( struct parse* parse ) {
-   // Macro: __LINE__
+   define_predef_macro( parse, "__LINE__", PREDEFMACRO_LINE );
+   define_predef_macro( parse, "__FILE__", PREDEFMACRO_FILE );
+   define_predef_macro( parse, "__TIME__", PREDEFMACRO_TIME );
+   define_predef_macro( parse, "__DATE__", PREDEFMACRO_DATE );
+}
+
+static void define_predef_macro( struct parse* parse, const char* name,
+   int predef ) {
    struct macro* macro = alloc_macro( parse );
-   macro->name = "__LINE__";
-   macro->predef = PREDEFMACRO_LINE;
-   append_macro( parse, macro );
-   // Macro: __FILE__
-   macro = alloc_macro( parse );
-   macro->name = "__FILE__";
-   macro->predef = PREDEFMACRO_FILE;
-   append_macro( parse, macro );
-   // Macro: __TIME__
-   macro = alloc_macro( parse );
-   macro->name = "__TIME__";
-   macro->predef = PREDEFMACRO_TIME;
-   append_macro( parse, macro );
-   // Macro: __DATE__
-   macro = alloc_macro( parse );
-   macro->name = "__DATE__";
-   macro->predef = PREDEFMACRO_DATE;
+   macro->name = name;
+   macro->atom = t_intern_atom( name, strlen( name ) );
+   macro->predef = predef;
    append_macro( parse, macro );
 }
 
@@ -922,7 +940,8 @@ void p_define_cmdline_macros( struct parse* parse ) {
    list_iterate( &parse->task->options->defines, &i );
    while ( ! list_end( &i ) ) {
       const char* name = list_data( &i );
-      struct macro* macro = p_find_macro( parse, name );
+      struct atom* atom = t_intern_atom( name, strlen( name ) );
+      struct macro* macro = p_find_macro( parse, atom );
       if ( ! macro ) {
          struct token* token = p_alloc_token( parse );
          p_init_token( token );
@@ -931,6 +950,7 @@ void p_define_cmdline_macros( struct parse* parse ) {
          token->length = strlen( CMDLINEMACRO_TEXT );
          macro = alloc_macro( parse );
          macro->name = name;
+         macro->atom = atom;
          macro->pos.id = INTERNALFILE_COMMANDLINE;
          append_token( macro, token );
          append_macro( parse, macro );
@@ -320,7 +320,7 @@ static int eval_ch( struct parse* parse ) {
 }
 
 static int eval_id( struct parse* parse ) {
-   if ( strcmp( parse->token->text, "defined" ) == 0 ) {
+   if ( parse->token->atom == parse->defined_atom ) {
       return eval_defined( parse );
    }
    else {
@@ -338,7 +338,7 @@ static int eval_defined( struct parse* parse ) {
       paren = true;
    }
    p_test_preptk( parse, TK_ID );
-   bool defined = p_is_macro_defined( parse, parse->token->text );
+   bool defined = p_is_macro_defined( parse, parse->token->atom );
    if ( paren ) {
       p_read_preptk( parse );
       p_test_preptk( parse, TK_PAREN_R );
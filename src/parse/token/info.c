@@ -1,3 +1,5 @@
+#include <string.h>
+
 #include "phase.h"
 
 // The table below contains information about the available tokens. The order
@@ -187,6 +189,42 @@ const struct token_info* p_get_token_info( enum tk tk ) {
    return &g_table[ tk ];
 }
 
+// Returns the token of the reserved identifier, or TK_ID when the atom is not
+// in the table. On the first lookup, the names are interned and the table is
+// sorted by atom ID, so the search compares atoms instead of text.
+enum tk p_find_keyword( struct keyword* table, int size, struct atom* atom ) {
+   if ( ! table[ 0 ].atom ) {
+      for ( int i = 0; i < size; ++i ) {
+         table[ i ].atom = t_intern_atom( table[ i ].name,
+            strlen( table[ i ].name ) );
+      }
+      for ( int i = 1; i < size; ++i ) {
+         struct keyword keyword = table[ i ];
+         int k = i;
+         while ( k > 0 && table[ k - 1 ].atom->id > keyword.atom->id ) {
+            table[ k ] = table[ k - 1 ];
+            --k;
+         }
+         table[ k ] = keyword;
+      }
+   }
+   int left = 0;
+   int right = size - 1;
+   while ( left <= right ) {
+      int middle = ( left + right ) / 2;
+      if ( atom->id > table[ middle ].atom->id ) {
+         left = middle + 1;
+      }
+      else if ( atom->id < table[ middle ].atom->id ) {
+         right = middle - 1;
+      }
+      else {
+         return table[ middle ].tk;
+      }
+   }
+   return TK_ID;
+}
+
 void p_present_token( struct str* str, enum tk tk ) {
    STATIC_ASSERT( TK_TOTAL == 157 );
    switch ( tk ) {
@@ -452,6 +452,7 @@ static void read_token_acs( struct parse* parse, struct token* token ) {
    int column = 0;
    enum tk tk = TK_END;
    struct str* text = NULL;
+   struct atom* atom = NULL;
 
    whitespace:
    // -----------------------------------------------------------------------
@@ -776,73 +777,69 @@ static void read_token_acs( struct parse* parse, struct token* token ) {
    identifier:
    // -----------------------------------------------------------------------
    {
-      // NOTE: Reserved identifiers must be listed in ascending order.
-      static const struct entry {
-         const char* name;
-         enum tk tk;
-      } table[] = {
-         { "acs_executewait", TK_ACSEXECUTEWAIT },
-         { "acs_namedexecutewait", TK_ACSNAMEDEXECUTEWAIT },
-         { "bluereturn", TK_BLUE_RETURN },
-         { "bool", TK_BOOL },
-         { "break", TK_BREAK },
-         { "case", TK_CASE },
-         { "clientside", TK_CLIENTSIDE },
-         { "const", TK_CONST },
-         { "continue", TK_CONTINUE },
-         { "createtranslation", TK_PALTRANS },
-         { "death", TK_DEATH },
-         { "default", TK_DEFAULT },
-         { "define", TK_DEFINE },
-         { "disconnect", TK_DISCONNECT },
-         { "do", TK_DO },
-         { "else", TK_ELSE },
-         { "encryptstrings", TK_ENCRYPTSTRINGS },
-         { "endregion", TK_ENDREGION },
-         { "enter", TK_ENTER },
-         { "event", TK_EVENT },
-         { "for", TK_FOR },
-         { "function", TK_FUNCTION },
-         { "global", TK_GLOBAL },
-         { "goto", TK_GOTO },
-         { "hudmessage", TK_HUDMESSAGE },
-         { "hudmessagebold", TK_HUDMESSAGEBOLD },
-         { "if", TK_IF },
-         { "import", TK_IMPORT },
-         { "include", TK_INCLUDE },
-         { "int", TK_INT },
-         { "kill", TK_KILL },
-         { "libdefine", TK_LIBDEFINE },
-         { "library", TK_LIBRARY },
-         { "lightning", TK_LIGHTNING },
-         { "log", TK_LOG },
-         { "net", TK_NET },
-         { "nocompact", TK_NOCOMPACT },
-         { "nowadauthor", TK_NOWADAUTHOR },
-         { "open", TK_OPEN },
-         { "pickup", TK_PICKUP },
-         { "redreturn", TK_RED_RETURN },
-         { "region", TK_REGION },
-         { "reopen", TK_REOPEN },
-         { "respawn", TK_RESPAWN },
-         { "restart", TK_RESTART },
-         { "return", TK_RETURN },
-         { "script", TK_SCRIPT },
-         { "special", TK_SPECIAL },
-         { "static", TK_STATIC },
-         { "str", TK_STR },
-         { "strcpy", TK_STRCPY },
-         { "strparam", TK_STRPARAM },
-         { "suspend", TK_SUSPEND },
-         { "switch", TK_SWITCH },
-         { "terminate", TK_TERMINATE },
-         { "unloading", TK_UNLOADING },
-         { "until", TK_UNTIL },
-         { "void", TK_VOID },
-         { "wadauthor", TK_WADAUTHOR },
-         { "while", TK_WHILE },
-         { "whitereturn", TK_WHITE_RETURN },
-         { "world", TK_WORLD }
+      static struct keyword table[] = {
+         { "acs_executewait", TK_ACSEXECUTEWAIT, NULL },
+         { "acs_namedexecutewait", TK_ACSNAMEDEXECUTEWAIT, NULL },
+         { "bluereturn", TK_BLUE_RETURN, NULL },
+         { "bool", TK_BOOL, NULL },
+         { "break", TK_BREAK, NULL },
+         { "case", TK_CASE, NULL },
+         { "clientside", TK_CLIENTSIDE, NULL },
+         { "const", TK_CONST, NULL },
+         { "continue", TK_CONTINUE, NULL },
+         { "createtranslation", TK_PALTRANS, NULL },
+         { "death", TK_DEATH, NULL },
+         { "default", TK_DEFAULT, NULL },
+         { "define", TK_DEFINE, NULL },
+         { "disconnect", TK_DISCONNECT, NULL },
+         { "do", TK_DO, NULL },
+         { "else", TK_ELSE, NULL },
+         { "encryptstrings", TK_ENCRYPTSTRINGS, NULL },
+         { "endregion", TK_ENDREGION, NULL },
+         { "enter", TK_ENTER, NULL },
+         { "event", TK_EVENT, NULL },
+         { "for", TK_FOR, NULL },
+         { "function", TK_FUNCTION, NULL },
+         { "global", TK_GLOBAL, NULL },
+         { "goto", TK_GOTO, NULL },
+         { "hudmessage", TK_HUDMESSAGE, NULL },
+         { "hudmessagebold", TK_HUDMESSAGEBOLD, NULL },
+         { "if", TK_IF, NULL },
+         { "import", TK_IMPORT, NULL },
+         { "include", TK_INCLUDE, NULL },
+         { "int", TK_INT, NULL },
+         { "kill", TK_KILL, NULL },
+         { "libdefine", TK_LIBDEFINE, NULL },
+         { "library", TK_LIBRARY, NULL },
+         { "lightning", TK_LIGHTNING, NULL },
+         { "log", TK_LOG, NULL },
+         { "net", TK_NET, NULL },
+         { "nocompact", TK_NOCOMPACT, NULL },
+         { "nowadauthor", TK_NOWADAUTHOR, NULL },
+         { "open", TK_OPEN, NULL },
+         { "pickup", TK_PICKUP, NULL },
+         { "redreturn", TK_RED_RETURN, NULL },
+         { "region", TK_REGION, NULL },
+         { "reopen", TK_REOPEN, NULL },
+         { "respawn", TK_RESPAWN, NULL },
+         { "restart", TK_RESTART, NULL },
+         { "return", TK_RETURN, NULL },
+         { "script", TK_SCRIPT, NULL },
+         { "special", TK_SPECIAL, NULL },
+         { "static", TK_STATIC, NULL },
+         { "str", TK_STR, NULL },
+         { "strcpy", TK_STRCPY, NULL },
+         { "strparam", TK_STRPARAM, NULL },
+         { "suspend", TK_SUSPEND, NULL },
+         { "switch", TK_SWITCH, NULL },
+         { "terminate", TK_TERMINATE, NULL },
+         { "unloading", TK_UNLOADING, NULL },
+         { "until", TK_UNTIL, NULL },
+         { "void", TK_VOID, NULL },
+         { "wadauthor", TK_WADAUTHOR, NULL },
+         { "while", TK_WHILE, NULL },
+         { "whitereturn", TK_WHITE_RETURN, NULL },
+         { "world", TK_WORLD, NULL }
       };
       text = temp_text( parse );
       while ( isalnum( ch ) || ch == '_' ) {
@@ -860,26 +857,12 @@ static void read_token_acs( struct parse* parse, struct token* token ) {
             MAX_IDENTIFIER_LENGTH );
          p_bail( parse );
       }
-      // Reserved identifier. Uses binary search.
-      int left = 0;
-      int right = ARRAY_SIZE( table ) - 1;
-      while ( left <= right ) {
-         int middle = ( left + right ) / 2;
-         int result = strcmp( text->value, table[ middle ].name );
-         if ( result > 0 ) {
-            left = middle + 1;
-         }
-         else if ( result < 0 ) {
-            right = middle - 1;
-         }
-         else {
-            tk = table[ middle ].tk;
-            text = NULL;
-            goto finish;
-         }
+      // Reserved identifier.
+      atom = t_intern_atom( text->value, text->length );
+      tk = p_find_keyword( table, ARRAY_SIZE( table ), atom );
+      if ( tk != TK_ID ) {
+         text = NULL;
       }
-      // Identifer.
-      tk = TK_ID;
       goto finish;
    }
 
@@ -1137,7 +1120,13 @@ static void read_token_acs( struct parse* parse, struct token* token ) {
    // -----------------------------------------------------------------------
    token->type = tk;
    token->modifiable_text = NULL;
-   if ( text ) {
+   token->atom = NULL;
+   if ( tk == TK_ID ) {
+      token->atom = atom;
+      token->text = token->atom->text;
+      token->length = text->length;
+   }
+   else if ( text ) {
       token->text = t_intern_text( parse->task, text->value, text->length );
       token->length = text->length;
    }
@@ -1161,6 +1150,7 @@ static void read_token_acs95( struct parse* parse, struct token* token ) {
    int column = 0;
    enum tk tk = TK_END;
    struct str* text = NULL;
+   struct atom* atom = NULL;
 
    whitespace:
    // -----------------------------------------------------------------------
@@ -1428,38 +1418,34 @@ static void read_token_acs95( struct parse* parse, struct token* token ) {
    identifier:
    // -----------------------------------------------------------------------
    {
-      // NOTE: Reserved identifiers must be listed in ascending order.
-      static const struct entry {
-         const char* name;
-         enum tk tk;
-      } table[] = {
-         { "break", TK_BREAK },
-         { "case", TK_CASE },
-         { "const", TK_CONST },
-         { "continue", TK_CONTINUE },
-         { "default", TK_DEFAULT },
-         { "define", TK_DEFINE },
-         { "do", TK_DO },
-         { "else", TK_ELSE },
-         { "for", TK_FOR },
-         { "goto", TK_GOTO },
-         { "if", TK_IF },
-         { "include", TK_INCLUDE },
-         { "int", TK_INT },
-         { "open", TK_OPEN },
-         { "print", TK_PRINT },
-         { "printbold", TK_PRINTBOLD },
-         { "restart", TK_RESTART },
-         { "script", TK_SCRIPT },
-         { "special", TK_SPECIAL },
-         { "str", TK_STR },
-         { "suspend", TK_SUSPEND },
-         { "switch", TK_SWITCH },
-         { "terminate", TK_TERMINATE },
-         { "until", TK_UNTIL },
-         { "void", TK_VOID },
-         { "while", TK_WHILE },
-         { "world", TK_WORLD },
+      static struct keyword table[] = {
+         { "break", TK_BREAK, NULL },
+         { "case", TK_CASE, NULL },
+         { "const", TK_CONST, NULL },
+         { "continue", TK_CONTINUE, NULL },
+         { "default", TK_DEFAULT, NULL },
+         { "define", TK_DEFINE, NULL },
+         { "do", TK_DO, NULL },
+         { "else", TK_ELSE, NULL },
+         { "for", TK_FOR, NULL },
+         { "goto", TK_GOTO, NULL },
+         { "if", TK_IF, NULL },
+         { "include", TK_INCLUDE, NULL },
+         { "int", TK_INT, NULL },
+         { "open", TK_OPEN, NULL },
+         { "print", TK_PRINT, NULL },
+         { "printbold", TK_PRINTBOLD, NULL },
+         { "restart", TK_RESTART, NULL },
+         { "script", TK_SCRIPT, NULL },
+         { "special", TK_SPECIAL, NULL },
+         { "str", TK_STR, NULL },
+         { "suspend", TK_SUSPEND, NULL },
+         { "switch", TK_SWITCH, NULL },
+         { "terminate", TK_TERMINATE, NULL },
+         { "until", TK_UNTIL, NULL },
+         { "void", TK_VOID, NULL },
+         { "while", TK_WHILE, NULL },
+         { "world", TK_WORLD, NULL }
       };
       text = temp_text( parse );
       while ( isalnum( ch ) || ch == '_' ) {
@@ -1477,26 +1463,12 @@ static void read_token_acs95( struct parse* parse, struct token* token ) {
             MAX_IDENTIFIER_LENGTH );
          p_bail( parse );
       }
-      // Reserved identifier. Uses binary search.
-      int left = 0;
-      int right = ARRAY_SIZE( table ) - 1;
-      while ( left <= right ) {
-         int middle = ( left + right ) / 2;
-         int result = strcmp( text->value, table[ middle ].name );
-         if ( result > 0 ) {
-            left = middle + 1;
-         }
-         else if ( result < 0 ) {
-            right = middle - 1;
-         }
-         else {
-            tk = table[ middle ].tk;
-            text = NULL;
-            goto finish;
-         }
+      // Reserved identifier.
+      atom = t_intern_atom( text->value, text->length );
+      tk = p_find_keyword( table, ARRAY_SIZE( table ), atom );
+      if ( tk != TK_ID ) {
+         text = NULL;
       }
-      // Identifer.
-      tk = TK_ID;
       goto finish;
    }
 
@@ -1717,7 +1689,13 @@ static void read_token_acs95( struct parse* parse, struct token* token ) {
    // -----------------------------------------------------------------------
    token->type = tk;
    token->modifiable_text = NULL;
-   if ( text ) {
+   token->atom = NULL;
+   if ( tk == TK_ID ) {
+      token->atom = atom;
+      token->text = token->atom->text;
+      token->length = text->length;
+   }
+   else if ( text ) {
       token->text = t_intern_text( parse->task, text->value, text->length );
       token->length = text->length;
    }
@@ -2569,7 +2547,14 @@ static void read_token( struct parse* parse, struct token* token ) {
    finish:
    // -----------------------------------------------------------------------
    token->type = tk;
-   if ( text != NULL ) {
+   token->atom = NULL;
+   if ( tk == TK_ID ) {
+      token->modifiable_text = NULL;
+      token->atom = t_intern_atom( text->value, text->length );
+      token->text = token->atom->text;
+      token->length = text->length;
+   }
+   else if ( text != NULL ) {
       token->modifiable_text = t_intern_text( parse->task, text->value,
          text->length );
       token->text = token->modifiable_text;
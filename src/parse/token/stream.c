@@ -66,7 +66,7 @@ static void expand_macro( struct parse* parse,
    struct macro_expan* expan );
 static void expand_id( struct parse* parse, struct macro_expan* expan );
 static struct macro_arg* find_arg( struct macro_expan* expan,
-   const char* param_name );
+   struct atom* param_name );
 static void stringize( struct parse* parse, struct macro_expan* expan );
 static bool expand_param( struct parse* parse, struct macro_expan* expan );
 static bool expand_nested_macro( struct parse* parse,
@@ -87,6 +87,7 @@ static void free_token_list( struct parse* parse, struct token* head,
 void p_init_stream( struct parse* parse ) {
    parse->tk = TK_END;
    parse->tk_text = "";
+   parse->tk_atom = NULL;
    parse->tk_length = 0;
    parse->token_free = NULL;
    parse->tkque_free_entry = NULL;
@@ -142,7 +143,7 @@ static void read_token( struct parse* parse, struct token* token ) {
 }
 
 bool p_expand_macro( struct parse* parse ) {
-   struct macro* macro = p_find_macro( parse, parse->token->text );
+   struct macro* macro = p_find_macro( parse, parse->token->atom );
    if ( ! macro ) {
       return false;
    }
@@ -594,7 +595,7 @@ static void expand_id( struct parse* parse, struct macro_expan* expan ) {
    if ( ( expan->token->next &&
       expan->token->next->type == TK_HASHHASH ) || (
       expan->output_tail && expan->output_tail->type == TK_HASHHASH ) ) {
-      struct macro_arg* arg = find_arg( expan, expan->token->text );
+      struct macro_arg* arg = find_arg( expan, expan->token->atom );
       if ( arg ) {
          if ( arg->sequence ) {
             struct token* token = arg->sequence;
@@ -625,10 +626,10 @@ static void expand_id( struct parse* parse, struct macro_expan* expan ) {
 }
 
 static struct macro_arg* find_arg( struct macro_expan* expan,
-   const char* param_name ) {
+   struct atom* param_name ) {
    struct macro_arg* arg = expan->args;
    struct macro_param* param = expan->macro->param_head;
-   while ( param && strcmp( param->name, param_name ) != 0 ) {
+   while ( param && param->atom != param_name ) {
       param = param->next;
       arg = arg->next;
    }
@@ -636,7 +637,7 @@ static struct macro_arg* find_arg( struct macro_expan* expan,
 }
 
 static bool expand_param( struct parse* parse, struct macro_expan* expan ) {
-   struct macro_arg* arg = find_arg( expan, expan->token->text );
+   struct macro_arg* arg = find_arg( expan, expan->token->atom );
    if ( ! arg ) {
       return false;
    }
@@ -659,7 +660,7 @@ static bool expand_param( struct parse* parse, struct macro_expan* expan ) {
 
 static bool expand_nested_macro( struct parse* parse,
    struct macro_expan* expan ) {
-   struct macro* macro = p_find_macro( parse, expan->arg_token->text );
+   struct macro* macro = p_find_macro( parse, expan->arg_token->atom );
    if ( ! macro ) {
       return false;
    }
@@ -726,7 +727,7 @@ static void output( struct parse* parse, struct macro_expan* expan,
 // `#` operator.
 static void stringize( struct parse* parse, struct macro_expan* expan ) {
    str_clear( &parse->temp_text );
-   struct macro_arg* arg = find_arg( expan, expan->token->text );
+   struct macro_arg* arg = find_arg( expan, expan->token->atom );
    struct token* token = arg->sequence;
    while ( token ) {
       str_append( &parse->temp_text, token->text );
@@ -790,6 +791,9 @@ static void concat_tangible( struct parse* parse, struct macro_expan* expan,
          parse->temp_text.value, parse->temp_text.length );
       token.text = token.modifiable_text;
       token.length = parse->temp_text.length;
+      if ( type == TK_ID ) {
+         token.atom = t_intern_atom( token.text, token.length );
+      }
    }
    p_free_token( parse, rside );
    p_free_token( parse, lside->next );
@@ -1011,6 +1015,7 @@ void p_init_token( struct token* token ) {
    token->next = NULL;
    token->modifiable_text = NULL;
    token->text = "";
+   token->atom = NULL;
    t_init_pos_id( &token->pos, INTERNALFILE_COMPILER );
    token->type = TK_END;
    token->length = 0;
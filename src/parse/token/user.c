@@ -21,6 +21,7 @@ void p_read_tk( struct parse* parse ) {
    struct token* token = parse->token;
    parse->tk = token->type;
    parse->tk_text = token->text;
+   parse->tk_atom = token->atom;
    parse->tk_pos = token->pos;
    parse->tk_length = token->length;
 }
@@ -82,97 +83,78 @@ static void read_token_bcs( struct parse* parse ) {
    identifier:
    // -----------------------------------------------------------------------
    {
-      char* text = parse->token->modifiable_text;
+      const char* text = parse->token->text;
       if ( ( parse->token->length >= 2 &&
-         ( islower( parse->token->text[ parse->token->length - 2 ] ) ||
-            parse->token->text[ parse->token->length - 2 ] == '_' ) &&
+         ( islower( text[ parse->token->length - 2 ] ) ||
+            text[ parse->token->length - 2 ] == '_' ) &&
          text[ parse->token->length - 1 ] == 'T' ) ||
-         ( parse->token->length == 1 && parse->token->text[ 0 ] == 'T' ) ) {
+         ( parse->token->length == 1 && text[ 0 ] == 'T' ) ) {
          parse->token->type = TK_TYPENAME;
       }
-      while ( *text ) {
-         *text = tolower( *text );
-         ++text;
-      }
+      // Identifiers are case-insensitive, so the parser sees them in
+      // lowercase.
+      parse->token->atom = t_lowercase_atom( parse->token->atom );
+      parse->token->text = parse->token->atom->text;
       // Type name.
       if ( parse->token->type == TK_TYPENAME ) {
          return;
       }
       // Reserved identifier.
-      static const struct {
-         const char* name;
-         enum tk tk;
-      } table[] = {
-         { "assert", TK_ASSERT },
-         { "auto", TK_AUTO },
-         { "bool", TK_BOOL },
-         { "break", TK_BREAK },
-         { "buildmsg", TK_BUILDMSG },
-         { "case", TK_CASE },
-         { "const", TK_CONST },
-         { "continue", TK_CONTINUE },
-         { "createtranslation", TK_PALTRANS },
-         { "default", TK_DEFAULT },
-         { "do", TK_DO },
-         { "else", TK_ELSE },
-         { "enum", TK_ENUM },
-         { "extern", TK_EXTERN },
-         { "false", TK_FALSE },
-         { "fixed", TK_FIXED },
-         { "for", TK_FOR },
-         { "foreach", TK_FOREACH },
-         { "function", TK_FUNCTION },
-         { "global", TK_GLOBAL },
-         { "goto", TK_GOTO },
-         { "if", TK_IF },
-         { "int", TK_INT },
-         { "lengthof", TK_LENGTHOF },
-         { "let", TK_LET },
-         { "memcpy", TK_MEMCPY },
-         { "namespace", TK_NAMESPACE },
-         { "null", TK_NULL },
-         { "private", TK_PRIVATE },
-         { "raw", TK_RAW },
-         { "restart", TK_RESTART },
-         { "return", TK_RETURN },
-         { "script", TK_SCRIPT },
-         { "special", TK_SPECIAL },
-         { "static", TK_STATIC },
-         { "str", TK_STR },
-         { "strcpy", TK_STRCPY },
-         { "strict", TK_STRICT },
-         { "struct", TK_STRUCT },
-         { "suspend", TK_SUSPEND },
-         { "switch", TK_SWITCH },
-         { "symb", TK_SYMB },
-         { "terminate", TK_TERMINATE },
-         { "true", TK_TRUE },
-         { "typedef", TK_TYPEDEF },
-         { "until", TK_UNTIL },
-         { "upmost", TK_UPMOST },
-         { "using", TK_USING },
-         { "void", TK_VOID },
-         { "while", TK_WHILE },
-         { "world", TK_WORLD },
-         // Terminator.
-         { "\x7F", TK_END }
+      static struct keyword table[] = {
+         { "assert", TK_ASSERT, NULL },
+         { "auto", TK_AUTO, NULL },
+         { "bool", TK_BOOL, NULL },
+         { "break", TK_BREAK, NULL },
+         { "buildmsg", TK_BUILDMSG, NULL },
+         { "case", TK_CASE, NULL },
+         { "const", TK_CONST, NULL },
+         { "continue", TK_CONTINUE, NULL },
+         { "createtranslation", TK_PALTRANS, NULL },
+         { "default", TK_DEFAULT, NULL },
+         { "do", TK_DO, NULL },
+         { "else", TK_ELSE, NULL },
+         { "enum", TK_ENUM, NULL },
+         { "extern", TK_EXTERN, NULL },
+         { "false", TK_FALSE, NULL },
+         { "fixed", TK_FIXED, NULL },
+         { "for", TK_FOR, NULL },
+         { "foreach", TK_FOREACH, NULL },
+         { "function", TK_FUNCTION, NULL },
+         { "global", TK_GLOBAL, NULL },
+         { "goto", TK_GOTO, NULL },
+         { "if", TK_IF, NULL },
+         { "int", TK_INT, NULL },
+         { "lengthof", TK_LENGTHOF, NULL },
+         { "let", TK_LET, NULL },
+         { "memcpy", TK_MEMCPY, NULL },
+         { "namespace", TK_NAMESPACE, NULL },
+         { "null", TK_NULL, NULL },
+         { "private", TK_PRIVATE, NULL },
+         { "raw", TK_RAW, NULL },
+         { "restart", TK_RESTART, NULL },
+         { "return", TK_RETURN, NULL },
+         { "script", TK_SCRIPT, NULL },
+         { "special", TK_SPECIAL, NULL },
+         { "static", TK_STATIC, NULL },
+         { "str", TK_STR, NULL },
+         { "strcpy", TK_STRCPY, NULL },
+         { "strict", TK_STRICT, NULL },
+         { "struct", TK_STRUCT, NULL },
+         { "suspend", TK_SUSPEND, NULL },
+         { "switch", TK_SWITCH, NULL },
+         { "symb", TK_SYMB, NULL },
+         { "terminate", TK_TERMINATE, NULL },
+         { "true", TK_TRUE, NULL },
+         { "typedef", TK_TYPEDEF, NULL },
+         { "until", TK_UNTIL, NULL },
+         { "upmost", TK_UPMOST, NULL },
+         { "using", TK_USING, NULL },
+         { "void", TK_VOID, NULL },
+         { "while", TK_WHILE, NULL },
+         { "world", TK_WORLD, NULL }
       };
-      int left = 0;
-      int right = ARRAY_SIZE( table ) - 1;
-      while ( left <= right ) {
-         int middle = ( left + right ) / 2;
-         int result = strcmp( parse->token->text, table[ middle ].name );
-         if ( result > 0 ) {
-            left = middle + 1;
-         }
-         else if ( result < 0 ) {
-            right = middle - 1;
-         }
-         else {
-            parse->token->type = table[ middle ].tk;
-            return;
-         }
-      }
+      parse->token->type = p_find_keyword( table, ARRAY_SIZE( table ),
+         parse->token->atom );
    }
    return;
 
@@ -538,7 +538,7 @@ static void test_label_arg( struct semantic* semantic, struct test* test,
    list_iterate( semantic->topfunc_test->labels, &i );
    while ( ! list_end( &i ) ) {
       struct label* label = list_data( &i );
-      if ( strcmp( label->name, arg->value.id ) == 0 ) {
+      if ( label->atom == arg->atom ) {
          arg->value.label = label;
          arg->type = INLINE_ASM_ARG_LABEL;
          return;
@@ -553,7 +553,7 @@ static void test_label_arg( struct semantic* semantic, struct test* test,
 static void test_var_arg( struct semantic* semantic, struct test* test,
    struct inline_asm_arg* arg ) {
    struct object_search search;
-   s_init_object_search( &search, NODE_NONE, &arg->pos, arg->value.id );
+   s_init_object_search( &search, NODE_NONE, &arg->pos, arg->atom );
    s_search_object( semantic, &search );
    struct object* object = search.object;
    if ( ! object ) {
@@ -623,13 +623,20 @@ static void test_var_arg( struct semantic* semantic, struct test* test,
    else {
       arg->type = INLINE_ASM_ARG_VAR;
       arg->value.var = var;
+      // The instruction might write the variable, so its value cannot be
+      // assumed to stay the initial one.
+      var->modified = true;
+      var->element_modified = true;
+      if ( var->storage == STORAGE_MAP ) {
+         s_record_use( semantic, &var->object );
+      }
    }
 }
 
 static void test_func_arg( struct semantic* semantic, struct test* test,
    struct inline_asm_arg* arg ) {
    struct object_search search;
-   s_init_object_search( &search, NODE_NONE, &arg->pos, arg->value.id );
+   s_init_object_search( &search, NODE_NONE, &arg->pos, arg->atom );
    s_search_object( semantic, &search );
    struct object* object = search.object;
    if ( ! object ) {
@@ -659,6 +666,9 @@ static void test_func_arg( struct semantic* semantic, struct test* test,
    }
    arg->type = INLINE_ASM_ARG_FUNC;
    arg->value.func = func;
+   if ( func->type == FUNC_USER ) {
+      s_record_use( semantic, &func->object );
+   }
 }
 
 static void test_expr_arg( struct semantic* semantic,
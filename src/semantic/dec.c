@@ -6,6 +6,12 @@
 #define SCRIPT_MIN_NUM 0
 #define SCRIPT_MAX_NUM 32767
 
+struct recursion_search {
+   struct func** stack;
+   int size;
+   int index;
+};
+
 struct enumeration_test {
    int value;
 };
@@ -134,6 +140,7 @@ static void merge_func_type( struct semantic* semantic, struct spec_test* test,
 static bool test_var_ref( struct semantic* semantic, struct var* var );
 static void init_ref_test( struct ref_test* test, struct ref* ref, int spec,
    bool need_public_spec );
+static bool depend_on( struct semantic* semantic, struct object* object );
 static bool test_ref( struct semantic* semantic, struct ref_test* test );
 static bool test_ref_struct( struct semantic* semantic, struct ref_test* test,
    struct ref_struct* structure );
@@ -251,6 +258,9 @@ static void bind_builtin_aliases( struct semantic* semantic,
 static void init_func_test( struct func_test* test, struct func_test* parent,
    struct func* func, struct list* labels, struct list* funcscope_vars,
    struct script* script );
+static void find_recursive_funcs( struct func* nested_funcs );
+static void visit_nested_func( struct recursion_search* search,
+   struct func* func );
 static void calc_param_size( struct param* param );
 static int calc_size( struct dim* dim, struct structure* structure,
    struct ref* ref );
@@ -460,7 +470,8 @@ static bool test_member_spec( struct semantic* semantic,
       s_bail( semantic );
    }
    if ( member->spec == SPEC_STRUCT ) {
-      if ( member->structure->object.resolved || member->ref ) {
+      if ( member->ref || depend_on( semantic,
+         &member->structure->object ) ) {
          return true;
       }
       else {
@@ -473,7 +484,7 @@ static bool test_member_spec( struct semantic* semantic,
       }
    }
    else if ( member->spec == SPEC_ENUM ) {
-      return member->enumeration->object.resolved;
+      return depend_on( semantic, &member->enumeration->object );
    }
    else {
       return true;
@@ -541,10 +552,10 @@ static bool test_typedef_spec( struct semantic* semantic,
       s_bail( semantic );
    }
    if ( alias->spec == SPEC_STRUCT ) {
-      return alias->structure->object.resolved;
+      return depend_on( semantic, &alias->structure->object );
    }
    else if ( alias->spec == SPEC_ENUM ) {
-      return alias->enumeration->object.resolved;
+      return depend_on( semantic, &alias->enumeration->object );
    }
    else {
       return true;
@@ -582,6 +593,9 @@ static bool test_typedef_dim( struct semantic* semantic,
 }
 
 void s_test_var( struct semantic* semantic, struct var* var ) {
+   if ( ! semantic->topfunc_test ) {
+      semantic->uses = &var->uses;
+   }
    if ( is_auto_var( var ) ) {
       test_auto_var( semantic, var );
    }
@@ -594,6 +608,7 @@ void s_test_var( struct semantic* semantic, struct var* var ) {
          test_var_initz( semantic, var ) &&
          test_var_finish( semantic, var );
    }
+   semantic->uses = NULL;
 }
 
 static bool test_var_spec( struct semantic* semantic, struct var* var ) {
@@ -620,10 +635,10 @@ static bool test_var_spec( struct semantic* semantic, struct var* var ) {
       s_bail( semantic );
    }
    if ( var->spec == SPEC_STRUCT ) {
-      return var->structure->object.resolved;
+      return depend_on( semantic, &var->structure->object );
    }
    else if ( var->spec == SPEC_ENUM ) {
-      return var->enumeration->object.resolved;
+      return depend_on( semantic, &var->enumeration->object );
    }
    else {
       return true;
@@ -725,6 +740,15 @@ static void find_name_spec( struct semantic* semantic,
    }
 }
 
+// Returns whether the object is resolved. If not, the object is recorded as the
+// one blocking the resolution of the namespace object being tested.
+static bool depend_on( struct semantic* semantic, struct object* object ) {
+   if ( ! object->resolved ) {
+      semantic->dependency = object;
+   }
+   return object->resolved;
+}
+
 struct path* s_last_path_part( struct path* path ) {
    while ( path->next ) {
       path = path->next;
@@ -798,7 +822,7 @@ static void merge_ref( struct semantic* semantic, struct spec_test* test,
          s_init_type_info( &type, alias->ref, alias->structure,
             alias->enumeration, alias->dim, alias->spec, STORAGE_MAP );
          struct type_snapshot snapshot;
-         s_take_type_snapshot( &type, &snapshot );
+         s_take_fine_type_snapshot( &type, &snapshot, false );
          if ( ref == test->ref ) {
             test->ref = snapshot.ref;
          }
@@ -1901,7 +1925,7 @@ static void assign_inferred_type( struct semantic* semantic, struct var* var,
       }
       else {
          struct type_snapshot snapshot;
-         s_take_type_snapshot( type, &snapshot );
+         s_take_type_snapshot( semantic, type, &snapshot );
          var->ref = snapshot.ref;
          var->structure = snapshot.structure;
          var->enumeration = snapshot.enumeration;
@@ -1958,6 +1982,15 @@ void s_test_func( struct semantic* semantic, struct func* func ) {
       test_special_func( semantic, func );
       break;
    case FUNC_USER:
+      // The default arguments are written where the function is called, so
+      // count them as uses of the function.
+      if ( ! semantic->topfunc_test ) {
+         struct func_user* impl = func->impl;
+         semantic->uses = &impl->uses;
+      }
+      test_func( semantic, func );
+      semantic->uses = NULL;
+      break;
    case FUNC_ALIAS:
       test_func( semantic, func );
       break;
@@ -2100,10 +2133,10 @@ static bool test_func_return_spec( struct semantic* semantic,
       s_bail( semantic );
    }
    if ( func->return_spec == SPEC_STRUCT ) {
-      return func->structure->object.resolved;
+      return depend_on( semantic, &func->structure->object );
    }
    else if ( func->return_spec == SPEC_ENUM ) {
-      return func->enumeration->object.resolved;
+      return depend_on( semantic, &func->enumeration->object );
    }
    else {
       return true;
@@ -2224,10 +2257,10 @@ static bool test_param_spec( struct semantic* semantic,
       s_bail( semantic );
    }
    if ( param->spec == SPEC_STRUCT ) {
-      return param->structure->object.resolved;
+      return depend_on( semantic, &param->structure->object );
    }
    else if ( param->spec == SPEC_ENUM ) {
-      return param->enumeration->object.resolved;
+      return depend_on( semantic, &param->enumeration->object );
    }
    else {
       return true;
@@ -2428,10 +2461,12 @@ void s_test_func_body( struct semantic* semantic, struct func* func ) {
    }
    semantic->func_test = &test;
    s_test_func_block( semantic, func, impl->body );
+   list_deinit( &test.non_null_refs );
    semantic->func_test = test.parent;
    impl->returns = test.returns;
    if ( ! impl->nested ) {
       impl->nested_funcs = test.nested_funcs;
+      find_recursive_funcs( impl->nested_funcs );
       semantic->topfunc_test = NULL;
    }
    s_pop_scope( semantic );
@@ -2475,6 +2510,7 @@ static void init_func_test( struct func_test* test, struct func_test* parent,
    test->parent = parent;
    test->script = script;
    test->enclosing_buildmsg = NULL;
+   list_init( &test->non_null_refs );
 }
 
 void s_test_nested_func( struct semantic* semantic, struct func* func ) {
@@ -2489,6 +2525,89 @@ void s_test_nested_func( struct semantic* semantic, struct func* func ) {
    }
 }
 
+// A nested function is recursive when it is part of a cycle in the call graph.
+// The cycles are the strongly connected components of the graph, found with
+// Tarjan's algorithm. Only calls between the nested functions of the same
+// script or function are part of the graph.
+static void find_recursive_funcs( struct func* nested_funcs ) {
+   int count = 0;
+   struct func* func = nested_funcs;
+   while ( func ) {
+      struct func_user* impl = func->impl;
+      ++count;
+      func = impl->next_nested;
+   }
+   if ( count == 0 ) {
+      return;
+   }
+   struct recursion_search search;
+   search.stack = mem_alloc( sizeof( *search.stack ) * count );
+   search.size = 0;
+   search.index = 0;
+   func = nested_funcs;
+   while ( func ) {
+      struct func_user* impl = func->impl;
+      if ( impl->call_index == -1 ) {
+         visit_nested_func( &search, func );
+      }
+      func = impl->next_nested;
+   }
+   mem_free( search.stack );
+}
+
+static void visit_nested_func( struct recursion_search* search,
+   struct func* func ) {
+   struct func_user* impl = func->impl;
+   impl->call_index = search->index;
+   impl->call_lowlink = search->index;
+   ++search->index;
+   int start = search->size;
+   search->stack[ search->size ] = func;
+   ++search->size;
+   // Only the callers of a function are recorded, so the edges are followed
+   // backwards. The reversed graph has the same components.
+   bool calls_itself = false;
+   struct call* call = impl->nested_calls;
+   while ( call ) {
+      struct func* caller = call->nested_call->caller;
+      if ( caller ) {
+         struct func_user* caller_impl = caller->impl;
+         if ( caller == func ) {
+            calls_itself = true;
+         }
+         else if ( caller_impl->call_index == -1 ) {
+            visit_nested_func( search, caller );
+            // A caller popped in its own component cannot lower the
+            // position.
+            if ( caller_impl->call_lowlink >= 0 &&
+               caller_impl->call_lowlink < impl->call_lowlink ) {
+               impl->call_lowlink = caller_impl->call_lowlink;
+            }
+         }
+         // A caller with a position of 0 or higher is on the stack, and so
+         // is part of the component being searched.
+         else if ( caller_impl->call_lowlink >= 0 &&
+            caller_impl->call_index < impl->call_lowlink ) {
+            impl->call_lowlink = caller_impl->call_index;
+         }
+      }
+      call = call->nested_call->next;
+   }
+   // Pop the component.
+   if ( impl->call_lowlink == impl->call_index ) {
+      bool recursive = ( search->size - start > 1 || calls_itself );
+      while ( search->size > start ) {
+         --search->size;
+         struct func_user* member_impl = search->stack[ search->size ]->impl;
+         if ( recursive ) {
+            member_impl->recursive = RECURSIVE_POSSIBLY;
+         }
+         // Removed from the stack.
+         member_impl->call_lowlink = -1;
+      }
+   }
+}
+
 void s_test_script( struct semantic* semantic, struct script* script ) {
    if ( script->number ) {
       test_script_number( semantic, script );
@@ -2594,7 +2713,9 @@ static void test_script_body( struct semantic* semantic,
    semantic->topfunc_test = &test;
    semantic->func_test = semantic->topfunc_test;
    s_test_top_block( semantic, script->body );
+   list_deinit( &test.non_null_refs );
    script->nested_funcs = test.nested_funcs;
+   find_recursive_funcs( script->nested_funcs );
    semantic->topfunc_test = NULL;
    semantic->func_test = NULL;
    s_pop_scope( semantic );
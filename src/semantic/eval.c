@@ -0,0 +1,1027 @@
+#include <limits.h>
+
+#include "phase.h"
+
+// Evaluation of a call is abandoned when it takes too long or goes too deep,
+// and the call is then made at run time.
+enum { MAX_EVAL_STEPS = 100000 };
+enum { MAX_EVAL_DEPTH = 64 };
+
+enum { FIXED_WHOLE = 65536 };
+
+struct binding {
+   struct node* object;
+   int value;
+   bool set;
+};
+
+struct evaluator {
+   jmp_buf bail;
+   struct binding* bindings;
+   int num_bindings;
+   int capacity;
+   int frame_start;
+   int steps;
+   int depth;
+   int return_value;
+};
+
+enum flow {
+   FLOW_NEXT,
+   FLOW_BREAK,
+   FLOW_CONTINUE,
+   FLOW_RETURN
+};
+
+static void eval_call( struct evaluator* evaluator, struct call* call );
+static bool is_pure_func( struct func* func );
+static bool is_pure_block( struct block* block );
+static bool is_pure_stmt( struct node* node );
+static bool is_pure_switch( struct switch_stmt* stmt );
+static bool is_pure_local_var( struct var* var );
+static bool is_pure_cond( struct expr* expr );
+static bool is_pure_expr( struct expr* expr );
+static bool is_pure_node( struct node* node );
+static bool is_pure_object( struct node* object );
+static bool is_pure_binary( struct binary* binary );
+static bool is_pure_conversion( struct conversion* conv );
+static bool is_pure_call( struct call* call );
+static bool is_writable_object( struct node* node );
+static bool is_primitive_spec( int spec );
+static int call_func( struct evaluator* evaluator, struct func* func,
+   struct list* args );
+static enum flow exec_block( struct evaluator* evaluator,
+   struct block* block );
+static enum flow exec_stmt( struct evaluator* evaluator, struct node* node );
+static enum flow exec_if( struct evaluator* evaluator, struct if_stmt* stmt );
+static enum flow exec_switch( struct evaluator* evaluator,
+   struct switch_stmt* stmt );
+static enum flow exec_while( struct evaluator* evaluator,
+   struct while_stmt* stmt );
+static enum flow exec_do( struct evaluator* evaluator, struct do_stmt* stmt );
+static enum flow exec_for( struct evaluator* evaluator,
+   struct for_stmt* stmt );
+static enum flow exec_loop_body( struct evaluator* evaluator,
+   struct node* body, bool* done );
+static void exec_local_var( struct evaluator* evaluator, struct var* var );
+static void exec_expr_list( struct evaluator* evaluator, struct list* list );
+static bool eval_cond( struct evaluator* evaluator, struct expr* expr );
+static int eval_expr( struct evaluator* evaluator, struct expr* expr );
+static int eval_node( struct evaluator* evaluator, struct node* node );
+static int eval_object( struct evaluator* evaluator, struct node* object );
+static int eval_element( struct evaluator* evaluator, struct var* var,
+   int offset );
+static int eval_unary( struct evaluator* evaluator, struct unary* unary );
+static int eval_binary( struct evaluator* evaluator, struct binary* binary );
+static int eval_logical( struct evaluator* evaluator,
+   struct logical* logical );
+static int eval_conditional( struct evaluator* evaluator,
+   struct conditional* cond );
+static int eval_assign( struct evaluator* evaluator, struct assign* assign );
+static int eval_inc( struct evaluator* evaluator, struct inc* inc );
+static int eval_conversion( struct evaluator* evaluator,
+   struct conversion* conv );
+static int apply_op( struct evaluator* evaluator, int op, bool fixed, int l,
+   int r );
+static int fixed_mul( struct evaluator* evaluator, int l, int r );
+static int fixed_div( struct evaluator* evaluator, int l, int r );
+static struct node* writable_object( struct node* node );
+static struct binding* find_binding( struct evaluator* evaluator,
+   struct node* object );
+static void bind( struct evaluator* evaluator, struct node* object,
+   int value, bool set );
+static void add_binding( struct evaluator* evaluator, struct node* object,
+   int value, bool set );
+static void count_step( struct evaluator* evaluator );
+static void fail( struct evaluator* evaluator );
+
+// Calls to pure functions whose arguments are all constant are evaluated
+// here, after all functions are tested. A call that cannot be evaluated is
+// left alone and made at run time.
+void s_eval_const_calls( struct semantic* semantic ) {
+   struct evaluator evaluator;
+   evaluator.bindings = NULL;
+   evaluator.num_bindings = 0;
+   evaluator.capacity = 0;
+   struct list_iter i;
+   list_iterate( &semantic->const_calls, &i );
+   while ( ! list_end( &i ) ) {
+      eval_call( &evaluator, list_data( &i ) );
+      list_next( &i );
+   }
+   if ( evaluator.bindings ) {
+      mem_free( evaluator.bindings );
+   }
+}
+
+static void eval_call( struct evaluator* evaluator, struct call* call ) {
+   if ( call->folded || ! is_pure_func( call->func ) ) {
+      return;
+   }
+   evaluator->num_bindings = 0;
+   evaluator->frame_start = 0;
+   evaluator->steps = 0;
+   evaluator->depth = 0;
+   if ( setjmp( evaluator->bail ) == 0 ) {
+      call->value = call_func( evaluator, call->func, &call->args );
+      call->folded = true;
+   }
+}
+
+// Purity
+// ==========================================================================
+
+// A pure function only reads its parameters, its local variables, and map
+// variables that are never written, and only calls other pure functions. The
+// result is cached in the function. A function being checked is assumed to be
+// pure, so recursive calls don't loop. If the function turns out to be
+// impure, the evaluation of any function that calls it fails when it reaches
+// the call.
+static bool is_pure_func( struct func* func ) {
+   if ( func->type != FUNC_USER ) {
+      return false;
+   }
+   struct func_user* impl = func->impl;
+   if ( impl->purity == PURITY_UNDETERMINED ) {
+      impl->purity = PURITY_PURE;
+      bool pure = ( ! impl->nested && ! impl->local && impl->body &&
+         ! func->ref && func->return_spec != SPEC_VOID &&
+         func->return_spec != SPEC_STR );
+      struct param* param = func->params;
+      while ( pure && param ) {
+         pure = ( ! param->ref && ! param->structure &&
+            param->spec != SPEC_STR );
+         param = param->next;
+      }
+      if ( ! ( pure && is_pure_block( impl->body ) ) ) {
+         impl->purity = PURITY_IMPURE;
+      }
+   }
+   return ( impl->purity == PURITY_PURE );
+}
+
+static bool is_pure_block( struct block* block ) {
+   struct list_iter i;
+   list_iterate( &block->stmts, &i );
+   while ( ! list_end( &i ) ) {
+      if ( ! is_pure_stmt( list_data( &i ) ) ) {
+         return false;
+      }
+      list_next( &i );
+   }
+   return true;
+}
+
+static bool is_pure_stmt( struct node* node ) {
+   switch ( node->type ) {
+   case NODE_BLOCK:
+      return is_pure_block( ( struct block* ) node );
+   case NODE_IF: {
+         struct if_stmt* stmt = ( struct if_stmt* ) node;
+         return ( ! stmt->cond.var && is_pure_cond( stmt->cond.expr ) &&
+            is_pure_stmt( stmt->body ) && ( ! stmt->else_body ||
+            is_pure_stmt( stmt->else_body ) ) );
+      }
+   case NODE_SWITCH:
+      return is_pure_switch( ( struct switch_stmt* ) node );
+   case NODE_WHILE: {
+         struct while_stmt* stmt = ( struct while_stmt* ) node;
+         return ( stmt->cond.u.node->type == NODE_EXPR &&
+            is_pure_cond( stmt->cond.u.expr ) &&
+            is_pure_block( stmt->body ) );
+      }
+   case NODE_DO: {
+         struct do_stmt* stmt = ( struct do_stmt* ) node;
+         return ( is_pure_cond( stmt->cond ) && is_pure_block( stmt->body ) );
+      }
+   case NODE_FOR: {
+         struct for_stmt* stmt = ( struct for_stmt* ) node;
+         struct list_iter i;
+         list_iterate( &stmt->init, &i );
+         while ( ! list_end( &i ) ) {
+            struct node* init = list_data( &i );
+            if ( ! ( init->type == NODE_VAR ?
+               is_pure_local_var( ( struct var* ) init ) :
+               is_pure_expr( ( struct expr* ) init ) ) ) {
+               return false;
+            }
+            list_next( &i );
+         }
+         list_iterate( &stmt->post, &i );
+         while ( ! list_end( &i ) ) {
+            if ( ! is_pure_expr( list_data( &i ) ) ) {
+               return false;
+            }
+            list_next( &i );
+         }
+         return ( ( ! stmt->cond.u.node || (
+            stmt->cond.u.node->type == NODE_EXPR &&
+            is_pure_cond( stmt->cond.u.expr ) ) ) &&
+            is_pure_stmt( stmt->body ) );
+      }
+   case NODE_JUMP:
+      return true;
+   case NODE_RETURN: {
+         struct return_stmt* stmt = ( struct return_stmt* ) node;
+         return ( stmt->return_value && ! stmt->buildmsg &&
+            is_pure_expr( stmt->return_value ) );
+      }
+   case NODE_EXPR_STMT: {
+         struct expr_stmt* stmt = ( struct expr_stmt* ) node;
+         struct list_iter i;
+         list_iterate( &stmt->expr_list, &i );
+         while ( ! list_end( &i ) ) {
+            if ( ! is_pure_expr( list_data( &i ) ) ) {
+               return false;
+            }
+            list_next( &i );
+         }
+         return true;
+      }
+   case NODE_VAR:
+      return is_pure_local_var( ( struct var* ) node );
+   case NODE_ASSERT:
+      return ( ( struct assert* ) node )->is_static;
+   case NODE_CONSTANT:
+   case NODE_ENUMERATION:
+   case NODE_TYPE_ALIAS:
+   case NODE_FUNC:
+   case NODE_STRUCTURE:
+   case NODE_USING:
+      return true;
+   default:
+      return false;
+   }
+}
+
+// Only case labels found directly in the body of the switch statement are
+// supported.
+static bool is_pure_switch( struct switch_stmt* stmt ) {
+   if ( stmt->cond.var || stmt->cond.expr->spec == SPEC_STR ||
+      ! is_pure_expr( stmt->cond.expr ) ||
+      stmt->body->type != NODE_BLOCK ) {
+      return false;
+   }
+   struct block* body = ( struct block* ) stmt->body;
+   struct list_iter i;
+   list_iterate( &body->stmts, &i );
+   while ( ! list_end( &i ) ) {
+      struct node* node = list_data( &i );
+      if ( ! ( node->type == NODE_CASE || node->type == NODE_CASE_DEFAULT ||
+         is_pure_stmt( node ) ) ) {
+         return false;
+      }
+      list_next( &i );
+   }
+   return true;
+}
+
+static bool is_pure_local_var( struct var* var ) {
+   switch ( var->storage ) {
+   case STORAGE_LOCAL:
+      return ( ! var->dim && ! var->ref && ! var->structure &&
+         var->spec != SPEC_STR && ( ! var->initial || (
+         ! var->initial->multi && var->value->type == VALUE_EXPR &&
+         is_pure_expr( var->value->expr ) ) ) );
+   // A static variable is only pure when read, and only when it is never
+   // written.
+   case STORAGE_MAP:
+      return true;
+   default:
+      return false;
+   }
+}
+
+static bool is_pure_cond( struct expr* expr ) {
+   return ( expr->spec != SPEC_STR && is_pure_expr( expr ) );
+}
+
+static bool is_pure_expr( struct expr* expr ) {
+   return ( ! expr->has_str && is_pure_node( expr->root ) );
+}
+
+static bool is_pure_node( struct node* node ) {
+   switch ( node->type ) {
+   case NODE_LITERAL:
+   case NODE_FIXED_LITERAL:
+   case NODE_BOOLEAN:
+      return true;
+   case NODE_EXPR:
+      return is_pure_expr( ( struct expr* ) node );
+   case NODE_PAREN:
+      return is_pure_node( ( ( struct paren* ) node )->inside );
+   case NODE_NAME_USAGE:
+      return is_pure_object( ( ( struct name_usage* ) node )->object );
+   case NODE_QUALIFIEDNAMEUSAGE:
+      return is_pure_object(
+         ( ( struct qualified_name_usage* ) node )->object );
+   case NODE_UNARY: {
+         struct unary* unary = ( struct unary* ) node;
+         return ( is_primitive_spec( unary->operand_spec ) &&
+            is_pure_node( unary->operand ) );
+      }
+   case NODE_BINARY:
+      return is_pure_binary( ( struct binary* ) node );
+   case NODE_LOGICAL: {
+         struct logical* logical = ( struct logical* ) node;
+         return ( is_primitive_spec( logical->lside_spec ) &&
+            is_primitive_spec( logical->rside_spec ) &&
+            is_pure_node( logical->lside ) && is_pure_node( logical->rside ) );
+      }
+   case NODE_CONDITIONAL: {
+         struct conditional* cond = ( struct conditional* ) node;
+         return ( ! cond->ref && is_primitive_spec( cond->left_spec ) &&
+            is_pure_node( cond->left ) &&
+            ( ! cond->middle || is_pure_node( cond->middle ) ) &&
+            is_pure_node( cond->right ) );
+      }
+   case NODE_ASSIGN: {
+         struct assign* assign = ( struct assign* ) node;
+         return ( ( assign->lside_type == ASSIGNLSIDE_PRIMITIVE ||
+            assign->lside_type == ASSIGNLSIDE_PRIMITIVEFIXED ) &&
+            is_writable_object( assign->lside ) &&
+            is_pure_node( assign->rside ) );
+      }
+   case NODE_INC:
+      return is_writable_object( ( ( struct inc* ) node )->operand );
+   case NODE_CAST:
+      return is_pure_node( ( ( struct cast* ) node )->operand );
+   case NODE_CONVERSION:
+      return is_pure_conversion( ( struct conversion* ) node );
+   case NODE_CALL:
+      return is_pure_call( ( struct call* ) node );
+   case NODE_SUBSCRIPT: {
+         struct subscript* subscript = ( struct subscript* ) node;
+         return ( subscript->var && subscript->var->immutable );
+      }
+   default:
+      return false;
+   }
+}
+
+static bool is_pure_object( struct node* object ) {
+   switch ( object->type ) {
+   case NODE_CONSTANT:
+      return ( ! ( ( struct constant* ) object )->has_str );
+   case NODE_ENUMERATOR:
+      return ( ! ( ( struct enumerator* ) object )->has_str );
+   case NODE_VAR: {
+         struct var* var = ( struct var* ) object;
+         if ( var->storage == STORAGE_LOCAL ) {
+            return ( ! var->dim && ! var->ref && ! var->structure );
+         }
+         return ( var->immutable && ! var->dim );
+      }
+   case NODE_PARAM:
+      return true;
+   default:
+      return false;
+   }
+}
+
+static bool is_pure_binary( struct binary* binary ) {
+   switch ( binary->operand_type ) {
+   case BINARYOPERAND_PRIMITIVERAW:
+   case BINARYOPERAND_PRIMITIVEINT:
+   case BINARYOPERAND_PRIMITIVEFIXED:
+   case BINARYOPERAND_PRIMITIVEBOOL:
+      return ( is_pure_node( binary->lside ) &&
+         is_pure_node( binary->rside ) );
+   default:
+      return false;
+   }
+}
+
+static bool is_pure_conversion( struct conversion* conv ) {
+   return ( ! conv->from_ref && is_primitive_spec( conv->spec ) &&
+      is_primitive_spec( conv->spec_from ) && is_pure_expr( conv->expr ) );
+}
+
+static bool is_pure_call( struct call* call ) {
+   if ( ! ( call->func && call->func->type == FUNC_USER ) ) {
+      return false;
+   }
+   struct func_user* impl = call->func->impl;
+   if ( impl->nested || impl->local ) {
+      return false;
+   }
+   struct list_iter i;
+   list_iterate( &call->args, &i );
+   while ( ! list_end( &i ) ) {
+      if ( ! is_pure_expr( list_data( &i ) ) ) {
+         return false;
+      }
+      list_next( &i );
+   }
+   return true;
+}
+
+// Only local scalar variables and parameters can be written.
+static bool is_writable_object( struct node* node ) {
+   struct node* object = writable_object( node );
+   if ( object ) {
+      if ( object->type == NODE_VAR ) {
+         struct var* var = ( struct var* ) object;
+         return ( var->storage == STORAGE_LOCAL && ! var->dim &&
+            ! var->ref && ! var->structure && var->spec != SPEC_STR );
+      }
+      return ( object->type == NODE_PARAM );
+   }
+   return false;
+}
+
+static bool is_primitive_spec( int spec ) {
+   switch ( spec ) {
+   case SPEC_RAW:
+   case SPEC_INT:
+   case SPEC_FIXED:
+   case SPEC_BOOL:
+      return true;
+   default:
+      return false;
+   }
+}
+
+// Evaluation
+// ==========================================================================
+
+static int call_func( struct evaluator* evaluator, struct func* func,
+   struct list* args ) {
+   if ( ! is_pure_func( func ) || evaluator->depth == MAX_EVAL_DEPTH ) {
+      fail( evaluator );
+   }
+   // The arguments are bound as they are evaluated, but they are only
+   // visible to the called function. Until then, a lookup finds the binding
+   // of the caller first.
+   int frame_start = evaluator->num_bindings;
+   struct param* param = func->params;
+   struct list_iter i;
+   list_iterate( args, &i );
+   while ( ! list_end( &i ) ) {
+      int value = eval_expr( evaluator, list_data( &i ) );
+      add_binding( evaluator, &param->object.node, value, true );
+      param = param->next;
+      list_next( &i );
+   }
+   while ( param ) {
+      struct expr* value = param->default_value;
+      if ( ! ( value && value->folded && ! value->has_str ) ) {
+         fail( evaluator );
+      }
+      add_binding( evaluator, &param->object.node, value->value, true );
+      param = param->next;
+   }
+   int caller_frame_start = evaluator->frame_start;
+   evaluator->frame_start = frame_start;
+   ++evaluator->depth;
+   struct func_user* impl = func->impl;
+   if ( exec_block( evaluator, impl->body ) != FLOW_RETURN ) {
+      fail( evaluator );
+   }
+   --evaluator->depth;
+   evaluator->frame_start = caller_frame_start;
+   evaluator->num_bindings = frame_start;
+   return evaluator->return_value;
+}
+
+static enum flow exec_block( struct evaluator* evaluator,
+   struct block* block ) {
+   struct list_iter i;
+   list_iterate( &block->stmts, &i );
+   while ( ! list_end( &i ) ) {
+      enum flow flow = exec_stmt( evaluator, list_data( &i ) );
+      if ( flow != FLOW_NEXT ) {
+         return flow;
+      }
+      list_next( &i );
+   }
+   return FLOW_NEXT;
+}
+
+static enum flow exec_stmt( struct evaluator* evaluator, struct node* node ) {
+   count_step( evaluator );
+   switch ( node->type ) {
+   case NODE_BLOCK:
+      return exec_block( evaluator, ( struct block* ) node );
+   case NODE_IF:
+      return exec_if( evaluator, ( struct if_stmt* ) node );
+   case NODE_SWITCH:
+      return exec_switch( evaluator, ( struct switch_stmt* ) node );
+   case NODE_WHILE:
+      return exec_while( evaluator, ( struct while_stmt* ) node );
+   case NODE_DO:
+      return exec_do( evaluator, ( struct do_stmt* ) node );
+   case NODE_FOR:
+      return exec_for( evaluator, ( struct for_stmt* ) node );
+   case NODE_JUMP:
+      return ( ( ( struct jump* ) node )->type == JUMP_BREAK ?
+         FLOW_BREAK : FLOW_CONTINUE );
+   case NODE_RETURN:
+      evaluator->return_value = eval_expr( evaluator,
+         ( ( struct return_stmt* ) node )->return_value );
+      return FLOW_RETURN;
+   case NODE_EXPR_STMT:
+      exec_expr_list( evaluator,
+         &( ( struct expr_stmt* ) node )->expr_list );
+      return FLOW_NEXT;
+   case NODE_VAR:
+      exec_local_var( evaluator, ( struct var* ) node );
+      return FLOW_NEXT;
+   case NODE_CASE:
+   case NODE_CASE_DEFAULT:
+   case NODE_ASSERT:
+   case NODE_CONSTANT:
+   case NODE_ENUMERATION:
+   case NODE_TYPE_ALIAS:
+   case NODE_FUNC:
+   case NODE_STRUCTURE:
+   case NODE_USING:
+      return FLOW_NEXT;
+   default:
+      fail( evaluator );
+      return FLOW_NEXT;
+   }
+}
+
+static enum flow exec_if( struct evaluator* evaluator, struct if_stmt* stmt ) {
+   if ( eval_cond( evaluator, stmt->cond.expr ) ) {
+      return exec_stmt( evaluator, stmt->body );
+   }
+   else if ( stmt->else_body ) {
+      return exec_stmt( evaluator, stmt->else_body );
+   }
+   return FLOW_NEXT;
+}
+
+static enum flow exec_switch( struct evaluator* evaluator,
+   struct switch_stmt* stmt ) {
+   int value = eval_expr( evaluator, stmt->cond.expr );
+   struct case_label* target = stmt->case_default;
+   for ( int i = 0; i < stmt->num_cases; ++i ) {
+      if ( stmt->cases[ i ]->number->value == value ) {
+         target = stmt->cases[ i ];
+         break;
+      }
+   }
+   if ( ! target ) {
+      return FLOW_NEXT;
+   }
+   struct block* body = ( struct block* ) stmt->body;
+   bool found = false;
+   struct list_iter i;
+   list_iterate( &body->stmts, &i );
+   while ( ! list_end( &i ) ) {
+      struct node* node = list_data( &i );
+      if ( node == &target->node ) {
+         found = true;
+      }
+      if ( found ) {
+         enum flow flow = exec_stmt( evaluator, node );
+         if ( flow == FLOW_BREAK ) {
+            break;
+         }
+         else if ( flow != FLOW_NEXT ) {
+            return flow;
+         }
+      }
+      list_next( &i );
+   }
+   return FLOW_NEXT;
+}
+
+static enum flow exec_while( struct evaluator* evaluator,
+   struct while_stmt* stmt ) {
+   bool done = false;
+   while ( eval_cond( evaluator, stmt->cond.u.expr ) != stmt->until ) {
+      enum flow flow = exec_loop_body( evaluator, &stmt->body->node, &done );
+      if ( done ) {
+         return flow;
+      }
+   }
+   return FLOW_NEXT;
+}
+
+static enum flow exec_do( struct evaluator* evaluator, struct do_stmt* stmt ) {
+   bool done = false;
+   do {
+      enum flow flow = exec_loop_body( evaluator, &stmt->body->node, &done );
+      if ( done ) {
+         return flow;
+      }
+   } while ( eval_cond( evaluator, stmt->cond ) != stmt->until );
+   return FLOW_NEXT;
+}
+
+static enum flow exec_for( struct evaluator* evaluator,
+   struct for_stmt* stmt ) {
+   struct list_iter i;
+   list_iterate( &stmt->init, &i );
+   while ( ! list_end( &i ) ) {
+      struct node* node = list_data( &i );
+      if ( node->type == NODE_VAR ) {
+         exec_local_var( evaluator, ( struct var* ) node );
+      }
+      else {
+         eval_expr( evaluator, ( struct expr* ) node );
+      }
+      list_next( &i );
+   }
+   bool done = false;
+   while ( ! stmt->cond.u.node || eval_cond( evaluator, stmt->cond.u.expr ) ) {
+      enum flow flow = exec_loop_body( evaluator, stmt->body, &done );
+      if ( done ) {
+         return flow;
+      }
+      exec_expr_list( evaluator, &stmt->post );
+   }
+   return FLOW_NEXT;
+}
+
+// Sets `done` when the loop is left, and returns the flow that follows the
+// loop.
+static enum flow exec_loop_body( struct evaluator* evaluator,
+   struct node* body, bool* done ) {
+   enum flow flow = exec_stmt( evaluator, body );
+   switch ( flow ) {
+   case FLOW_BREAK:
+      *done = true;
+      return FLOW_NEXT;
+   case FLOW_RETURN:
+      *done = true;
+      return FLOW_RETURN;
+   default:
+      return FLOW_NEXT;
+   }
+}
+
+// A variable without an initializer keeps no known value, so reading it
+// before it is assigned stops the evaluation.
+static void exec_local_var( struct evaluator* evaluator, struct var* var ) {
+   if ( var->storage == STORAGE_LOCAL ) {
+      if ( var->initial ) {
+         bind( evaluator, &var->object.node,
+            eval_expr( evaluator, var->value->expr ), true );
+      }
+      else {
+         bind( evaluator, &var->object.node, 0, false );
+      }
+   }
+}
+
+static void exec_expr_list( struct evaluator* evaluator, struct list* list ) {
+   struct list_iter i;
+   list_iterate( list, &i );
+   while ( ! list_end( &i ) ) {
+      eval_expr( evaluator, list_data( &i ) );
+      list_next( &i );
+   }
+}
+
+static bool eval_cond( struct evaluator* evaluator, struct expr* expr ) {
+   return ( eval_expr( evaluator, expr ) != 0 );
+}
+
+static int eval_expr( struct evaluator* evaluator, struct expr* expr ) {
+   if ( expr->has_str ) {
+      fail( evaluator );
+   }
+   if ( expr->folded ) {
+      return expr->value;
+   }
+   return eval_node( evaluator, expr->root );
+}
+
+static int eval_node( struct evaluator* evaluator, struct node* node ) {
+   count_step( evaluator );
+   switch ( node->type ) {
+   case NODE_LITERAL:
+      return ( ( struct literal* ) node )->value;
+   case NODE_FIXED_LITERAL:
+      return ( ( struct fixed_literal* ) node )->value;
+   case NODE_BOOLEAN:
+      return ( ( struct boolean* ) node )->value;
+   case NODE_EXPR:
+      return eval_expr( evaluator, ( struct expr* ) node );
+   case NODE_PAREN:
+      return eval_node( evaluator, ( ( struct paren* ) node )->inside );
+   case NODE_NAME_USAGE:
+      return eval_object( evaluator,
+         ( ( struct name_usage* ) node )->object );
+   case NODE_QUALIFIEDNAMEUSAGE:
+      return eval_object( evaluator,
+         ( ( struct qualified_name_usage* ) node )->object );
+   case NODE_UNARY:
+      return eval_unary( evaluator, ( struct unary* ) node );
+   case NODE_BINARY:
+      return eval_binary( evaluator, ( struct binary* ) node );
+   case NODE_LOGICAL:
+      return eval_logical( evaluator, ( struct logical* ) node );
+   case NODE_CONDITIONAL:
+      return eval_conditional( evaluator, ( struct conditional* ) node );
+   case NODE_ASSIGN:
+      return eval_assign( evaluator, ( struct assign* ) node );
+   case NODE_INC:
+      return eval_inc( evaluator, ( struct inc* ) node );
+   case NODE_CAST:
+      return eval_node( evaluator, ( ( struct cast* ) node )->operand );
+   case NODE_CONVERSION:
+      return eval_conversion( evaluator, ( struct conversion* ) node );
+   case NODE_CALL: {
+         struct call* call = ( struct call* ) node;
+         if ( call->folded ) {
+            return call->value;
+         }
+         return call_func( evaluator, call->func, &call->args );
+      }
+   case NODE_SUBSCRIPT: {
+         struct subscript* subscript = ( struct subscript* ) node;
+         return eval_element( evaluator, subscript->var, subscript->offset );
+      }
+   default:
+      fail( evaluator );
+      return 0;
+   }
+}
+
+static int eval_object( struct evaluator* evaluator, struct node* object ) {
+   switch ( object->type ) {
+   case NODE_CONSTANT:
+      return ( ( struct constant* ) object )->value;
+   case NODE_ENUMERATOR:
+      return ( ( struct enumerator* ) object )->value;
+   case NODE_VAR: {
+         struct var* var = ( struct var* ) object;
+         if ( var->storage != STORAGE_LOCAL ) {
+            return eval_element( evaluator, var, 0 );
+         }
+      }
+      // FALLTHROUGH
+   case NODE_PARAM: {
+         struct binding* binding = find_binding( evaluator, object );
+         if ( ! ( binding && binding->set ) ) {
+            fail( evaluator );
+         }
+         return binding->value;
+      }
+   default:
+      fail( evaluator );
+      return 0;
+   }
+}
+
+static int eval_element( struct evaluator* evaluator, struct var* var,
+   int offset ) {
+   struct value* value = t_find_value( var, offset );
+   if ( ! value ) {
+      return 0;
+   }
+   if ( value->type != VALUE_EXPR || value->expr->has_str ) {
+      fail( evaluator );
+   }
+   return value->expr->value;
+}
+
+static int eval_unary( struct evaluator* evaluator, struct unary* unary ) {
+   int value = eval_node( evaluator, unary->operand );
+   switch ( unary->op ) {
+   case UOP_MINUS:
+      return ( int ) ( 0u - ( unsigned int ) value );
+   case UOP_LOG_NOT:
+      return ( ! value );
+   case UOP_BIT_NOT:
+      return ( ~ value );
+   default:
+      return value;
+   }
+}
+
+static int eval_binary( struct evaluator* evaluator, struct binary* binary ) {
+   int l = eval_node( evaluator, binary->lside );
+   int r = eval_node( evaluator, binary->rside );
+   bool fixed = ( binary->operand_type == BINARYOPERAND_PRIMITIVEFIXED );
+   switch ( binary->op ) {
+   case BOP_EQ: return ( l == r );
+   case BOP_NEQ: return ( l != r );
+   case BOP_LT: return ( l < r );
+   case BOP_LTE: return ( l <= r );
+   case BOP_GT: return ( l > r );
+   case BOP_GTE: return ( l >= r );
+   case BOP_BIT_OR: return apply_op( evaluator, AOP_BIT_OR, fixed, l, r );
+   case BOP_BIT_XOR: return apply_op( evaluator, AOP_BIT_XOR, fixed, l, r );
+   case BOP_BIT_AND: return apply_op( evaluator, AOP_BIT_AND, fixed, l, r );
+   case BOP_SHIFT_L: return apply_op( evaluator, AOP_SHIFT_L, fixed, l, r );
+   case BOP_SHIFT_R: return apply_op( evaluator, AOP_SHIFT_R, fixed, l, r );
+   case BOP_ADD: return apply_op( evaluator, AOP_ADD, fixed, l, r );
+   case BOP_SUB: return apply_op( evaluator, AOP_SUB, fixed, l, r );
+   case BOP_MUL: return apply_op( evaluator, AOP_MUL, fixed, l, r );
+   case BOP_DIV: return apply_op( evaluator, AOP_DIV, fixed, l, r );
+   case BOP_MOD: return apply_op( evaluator, AOP_MOD, fixed, l, r );
+   default:
+      fail( evaluator );
+      return 0;
+   }
+}
+
+static int eval_logical( struct evaluator* evaluator,
+   struct logical* logical ) {
+   bool value = ( eval_node( evaluator, logical->lside ) != 0 );
+   if ( ( logical->op == LOP_OR ) != value ) {
+      value = ( eval_node( evaluator, logical->rside ) != 0 );
+   }
+   return value;
+}
+
+static int eval_conditional( struct evaluator* evaluator,
+   struct conditional* cond ) {
+   int value = eval_node( evaluator, cond->left );
+   if ( value != 0 ) {
+      return ( cond->middle ? eval_node( evaluator, cond->middle ) : value );
+   }
+   return eval_node( evaluator, cond->right );
+}
+
+static int eval_assign( struct evaluator* evaluator, struct assign* assign ) {
+   struct binding* binding = find_binding( evaluator,
+      writable_object( assign->lside ) );
+   if ( ! binding ) {
+      fail( evaluator );
+   }
+   int value = eval_node( evaluator, assign->rside );
+   // The binding array can move while the right side is evaluated.
+   binding = find_binding( evaluator, writable_object( assign->lside ) );
+   if ( assign->op != AOP_NONE ) {
+      if ( ! binding->set ) {
+         fail( evaluator );
+      }
+      value = apply_op( evaluator, assign->op,
+         ( assign->lside_type == ASSIGNLSIDE_PRIMITIVEFIXED ),
+         binding->value, value );
+   }
+   binding->value = value;
+   binding->set = true;
+   return value;
+}
+
+static int eval_inc( struct evaluator* evaluator, struct inc* inc ) {
+   struct binding* binding = find_binding( evaluator,
+      writable_object( inc->operand ) );
+   if ( ! ( binding && binding->set ) ) {
+      fail( evaluator );
+   }
+   int value = binding->value;
+   int step = ( inc->fixed ? FIXED_WHOLE : 1 );
+   binding->value = apply_op( evaluator, ( inc->dec ? AOP_SUB : AOP_ADD ),
+      false, value, step );
+   return ( inc->post ? value : binding->value );
+}
+
+static int eval_conversion( struct evaluator* evaluator,
+   struct conversion* conv ) {
+   int value = eval_expr( evaluator, conv->expr );
+   switch ( conv->spec ) {
+   case SPEC_INT:
+   case SPEC_RAW:
+      if ( conv->spec_from == SPEC_FIXED ) {
+         return value / FIXED_WHOLE;
+      }
+      return value;
+   case SPEC_FIXED:
+      if ( conv->spec_from != SPEC_FIXED ) {
+         return ( int ) ( ( unsigned int ) value << 16 );
+      }
+      return value;
+   case SPEC_BOOL:
+      return ( value != 0 );
+   default:
+      fail( evaluator );
+      return 0;
+   }
+}
+
+// Integer arithmetic wraps around like it does in the engine. Operations with
+// undefined results stop the evaluation.
+static int apply_op( struct evaluator* evaluator, int op, bool fixed, int l,
+   int r ) {
+   switch ( op ) {
+   case AOP_NONE:
+      return r;
+   case AOP_ADD:
+      return ( int ) ( ( unsigned int ) l + ( unsigned int ) r );
+   case AOP_SUB:
+      return ( int ) ( ( unsigned int ) l - ( unsigned int ) r );
+   case AOP_MUL:
+      if ( fixed ) {
+         return fixed_mul( evaluator, l, r );
+      }
+      return ( int ) ( ( unsigned int ) l * ( unsigned int ) r );
+   case AOP_DIV:
+   case AOP_MOD:
+      if ( fixed && op == AOP_DIV ) {
+         return fixed_div( evaluator, l, r );
+      }
+      if ( r == 0 || ( l == INT_MIN && r == -1 ) ) {
+         fail( evaluator );
+      }
+      return ( op == AOP_DIV ? l / r : l % r );
+   case AOP_SHIFT_L:
+   case AOP_SHIFT_R:
+      if ( r < 0 || r > 31 ) {
+         fail( evaluator );
+      }
+      return ( op == AOP_SHIFT_L ? ( int ) ( ( unsigned int ) l << r ) :
+         l >> r );
+   case AOP_BIT_AND:
+      return ( l & r );
+   case AOP_BIT_XOR:
+      return ( l ^ r );
+   case AOP_BIT_OR:
+      return ( l | r );
+   default:
+      fail( evaluator );
+      return 0;
+   }
+}
+
+static int fixed_mul( struct evaluator* evaluator, int l, int r ) {
+   i64 result = ( ( i64 ) l * r ) >> 16;
+   if ( result < INT_MIN || result > INT_MAX ) {
+      fail( evaluator );
+   }
+   return ( int ) result;
+}
+
+static int fixed_div( struct evaluator* evaluator, int l, int r ) {
+   if ( r == 0 ) {
+      fail( evaluator );
+   }
+   i64 result = ( ( i64 ) l * FIXED_WHOLE ) / r;
+   if ( result < INT_MIN || result > INT_MAX ) {
+      fail( evaluator );
+   }
+   return ( int ) result;
+}
+
+static struct node* writable_object( struct node* node ) {
+   while ( node->type == NODE_PAREN ) {
+      node = ( ( struct paren* ) node )->inside;
+   }
+   switch ( node->type ) {
+   case NODE_NAME_USAGE:
+      return ( ( struct name_usage* ) node )->object;
+   case NODE_QUALIFIEDNAMEUSAGE:
+      return ( ( struct qualified_name_usage* ) node )->object;
+   default:
+      return NULL;
+   }
+}
+
+// Each object has at most one binding in a frame, so the first binding found
+// from the start of the frame is the one of the current function.
+static struct binding* find_binding( struct evaluator* evaluator,
+   struct node* object ) {
+   for ( int i = evaluator->frame_start; i < evaluator->num_bindings; ++i ) {
+      if ( evaluator->bindings[ i ].object == object ) {
+         return &evaluator->bindings[ i ];
+      }
+   }
+   return NULL;
+}
+
+// A declaration that is executed again, in a loop, reuses its binding.
+static void bind( struct evaluator* evaluator, struct node* object,
+   int value, bool set ) {
+   struct binding* binding = find_binding( evaluator, object );
+   if ( binding ) {
+      binding->value = value;
+      binding->set = set;
+   }
+   else {
+      add_binding( evaluator, object, value, set );
+   }
+}
+
+static void add_binding( struct evaluator* evaluator, struct node* object,
+   int value, bool set ) {
+   if ( evaluator->num_bindings == evaluator->capacity ) {
+      evaluator->capacity = evaluator->capacity ?
+         evaluator->capacity * 2 : 16;
+      evaluator->bindings = mem_realloc( evaluator->bindings,
+         sizeof( *evaluator->bindings ) * evaluator->capacity );
+   }
+   struct binding* binding = &evaluator->bindings[ evaluator->num_bindings ];
+   binding->object = object;
+   binding->value = value;
+   binding->set = set;
+   ++evaluator->num_bindings;
+}
+
+static void count_step( struct evaluator* evaluator ) {
+   ++evaluator->steps;
+   if ( evaluator->steps > MAX_EVAL_STEPS ) {
+      fail( evaluator );
+   }
+}
+
+static void fail( struct evaluator* evaluator ) {
+   longjmp( evaluator->bail, 1 );
+}
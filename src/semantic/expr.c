@@ -13,6 +13,9 @@ struct result {
       int dim_depth;
    } data_origin;
    struct object* object;
+   // Usage of a local reference variable or parameter whose null checks can
+   // be tracked.
+   struct name_usage* name_usage;
    struct dim* dim;
    int value;
    bool complete;
@@ -20,6 +23,8 @@ struct result {
    bool modifiable;
    bool folded;
    bool in_paren;
+   // Operand of a call. The call records the use of the called function.
+   bool callee;
 };
 
 struct call_test {
@@ -33,7 +38,7 @@ struct call_test {
 };
 
 struct general_name_usage_test {
-   const char* text;
+   struct atom* name;
    struct pos* pos;
    struct path* path;
    struct node* object;
@@ -78,6 +83,8 @@ static void fold_bop_str( struct semantic* semantic, struct binary* binary,
    struct result* lside, struct result* rside );
 static void fold_bop_str_compare( struct semantic* semantic,
    struct binary* binary, struct result* lside, struct result* rside );
+static void warn_zero_divisor( struct semantic* semantic, struct pos* pos,
+   struct result* divisor );
 static void test_logical( struct semantic* semantic, struct expr_test* test,
    struct result* result, struct logical* logical );
 static bool perform_logical( struct semantic* semantic,
@@ -192,7 +199,9 @@ static void test_int_arg( struct semantic* semantic, struct expr_test* test,
    struct expr* expr );
 static void test_buildmsg( struct semantic* semantic,
    struct expr_test* expr_test, struct call* call );
-static void add_nested_call( struct func* func, struct call* call );
+static void add_nested_call( struct semantic* semantic, struct func* func,
+   struct call* call );
+static bool is_const_call( struct func* func, struct call* call );
 static void test_remaining_args( struct semantic* semantic,
    struct expr_test* expr_test, struct call_test* test );
 static void test_remaining_arg( struct semantic* semantic,
@@ -228,7 +237,7 @@ static void test_qualified_name_usage( struct semantic* semantic,
    struct expr_test* expr_test, struct result* result,
    struct qualified_name_usage* usage );
 static void init_general_name_usage_test( struct general_name_usage_test* test,
-   struct pos* pos, const char* text, struct path* path );
+   struct pos* pos, struct atom* name, struct path* path );
 static void test_general_name_usage( struct semantic* semantic,
    struct expr_test* expr_test, struct result* result,
    struct general_name_usage_test* test );
@@ -285,6 +294,18 @@ static void test_upmost( struct semantic* semantic, struct result* result );
 static void test_current_namespace( struct semantic* semantic,
    struct result* result );
 static void test_null( struct result* result );
+static bool is_tracked_ref( struct node* object );
+static bool is_non_null_ref( struct semantic* semantic, struct node* object );
+static void add_non_null_ref( struct semantic* semantic, struct node* object );
+static void remove_non_null_ref( struct semantic* semantic,
+   struct node* object );
+static bool lost_non_null_refs( struct semantic* semantic,
+   struct list* refs );
+static void note_null_check( struct semantic* semantic,
+   struct result* result );
+static void assume_operand( struct semantic* semantic, struct node* node,
+   bool value );
+static struct name_usage* get_tracked_usage( struct node* node );
 
 void s_init_expr_test( struct expr_test* test, bool result_required,
    bool suggest_paren_assign ) {
@@ -386,6 +407,7 @@ static void init_result( struct result* result ) {
    result->data_origin.structure_member = NULL;
    result->data_origin.dim_depth = 0;
    result->object = NULL;
+   result->name_usage = NULL;
    result->dim = NULL;
    result->value = 0;
    result->complete = false;
@@ -393,6 +415,7 @@ static void init_result( struct result* result ) {
    result->modifiable = false;
    result->folded = false;
    result->in_paren = false;
+   result->callee = false;
 }
 
 static void test_operand( struct semantic* semantic, struct expr_test* test,
@@ -468,6 +491,9 @@ static void test_binary( struct semantic* semantic, struct expr_test* test,
    if ( lside.folded && rside.folded ) {
       fold_bop( semantic, binary, &lside, &rside, result );
    }
+   else if ( binary->op == BOP_DIV || binary->op == BOP_MOD ) {
+      warn_zero_divisor( semantic, &binary->pos, &rside );
+   }
 }
 
 static bool perform_bop( struct semantic* semantic, struct binary* binary,
@@ -797,6 +823,16 @@ static void fold_bop_str_compare( struct semantic* semantic,
    binary->folded = true;
 }
 
+// A division by a constant zero cannot be evaluated at compile time, and
+// will stop the script when executed.
+static void warn_zero_divisor( struct semantic* semantic, struct pos* pos,
+   struct result* divisor ) {
+   if ( divisor->folded && divisor->value == 0 ) {
+      s_diag( semantic, DIAG_WARN | DIAG_POS, pos,
+         "division by zero" );
+   }
+}
+
 static void test_logical( struct semantic* semantic, struct expr_test* test,
    struct result* result, struct logical* logical ) {
    struct result lside;
@@ -807,9 +843,20 @@ static void test_logical( struct semantic* semantic, struct expr_test* test,
          "left operand not a value" );
       s_bail( semantic );
    }
+   // The right operand is evaluated only when the left operand does not
+   // decide the result.
+   struct list saved_refs;
+   s_save_non_null_refs( semantic, &saved_refs );
+   assume_operand( semantic, logical->lside, ( logical->op == LOP_AND ) );
+   struct list assumed_refs;
+   s_save_non_null_refs( semantic, &assumed_refs );
    struct result rside;
    init_result( &rside );
    test_operand( semantic, test, &rside, logical->rside );
+   logical->rside_changes_refs = lost_non_null_refs( semantic,
+      &assumed_refs );
+   list_deinit( &assumed_refs );
+   s_restore_surviving_non_null_refs( semantic, &saved_refs );
    if ( ! rside.usable ) {
       s_diag( semantic, DIAG_POS_ERR, &logical->pos,
          "right operand not a value" );
@@ -962,6 +1009,9 @@ static void test_assign( struct semantic* semantic, struct expr_test* test,
          "invalid assignment operation" );
       s_bail( semantic );
    }
+   if ( assign->op == AOP_DIV || assign->op == AOP_MOD ) {
+      warn_zero_divisor( semantic, &assign->pos, &rside );
+   }
    // Note which variable is passed by reference.
    if ( s_is_ref_type( &lside.type ) ) {
       if ( rside.data_origin.var ) {
@@ -984,6 +1034,18 @@ static void test_assign( struct semantic* semantic, struct expr_test* test,
          var->modified = true;
       }
    }
+   else if ( lside.data_origin.var ) {
+      lside.data_origin.var->element_modified = true;
+   }
+   // Track whether the assigned reference is null.
+   if ( lside.name_usage ) {
+      remove_non_null_ref( semantic, lside.name_usage->object );
+      if ( ( s_is_ref_type( &rside.type ) && ! s_is_null( &rside.type ) &&
+         ! s_is_nullable( &rside.type ) ) || ( rside.name_usage &&
+         is_non_null_ref( semantic, rside.name_usage->object ) ) ) {
+         add_non_null_ref( semantic, lside.name_usage->object );
+      }
+   }
    // To avoid the error where the user wanted equality operator but instead
    // typed in the assignment operator, suggest that assignment be wrapped in
    // parentheses.
@@ -1145,10 +1207,14 @@ static void test_conditional( struct semantic* semantic,
          "left operand cannot be converted to a boolean value" );
       s_bail( semantic );
    }
+   struct list saved_refs;
    struct result middle = left;
    if ( cond->middle ) {
+      s_save_non_null_refs( semantic, &saved_refs );
+      assume_operand( semantic, cond->left, true );
       init_result( &middle );
       test_operand( semantic, test, &middle, cond->middle );
+      s_restore_surviving_non_null_refs( semantic, &saved_refs );
    }
    if ( middle.func && middle.func->type == FUNC_USER ) {
       struct func_user* impl = middle.func->impl;
@@ -1159,9 +1225,12 @@ static void test_conditional( struct semantic* semantic,
          s_bail( semantic );
       }
    }
+   s_save_non_null_refs( semantic, &saved_refs );
+   assume_operand( semantic, cond->left, false );
    struct result right;
    init_result( &right );
    test_operand( semantic, test, &right, cond->right );
+   s_restore_surviving_non_null_refs( semantic, &saved_refs );
    if ( right.func && right.func->type == FUNC_USER ) {
       struct func_user* impl = right.func->impl;
       if ( impl->local ) {
@@ -1178,7 +1247,7 @@ static void test_conditional( struct semantic* semantic,
       s_bail( semantic );
    }
    struct type_snapshot snapshot;
-   s_take_type_snapshot( &result_type, &snapshot );
+   s_take_type_snapshot( semantic, &result_type, &snapshot );
    s_init_type_info( &result->type, snapshot.ref, snapshot.structure,
       snapshot.enumeration, NULL, snapshot.spec, STORAGE_LOCAL );
    result->complete = true;
@@ -1462,6 +1531,9 @@ static void test_inc( struct semantic* semantic, struct expr_test* test,
          var->modified = true;
       }
    }
+   else if ( operand.data_origin.var ) {
+      operand.data_origin.var->element_modified = true;
+   }
 }
 
 static bool perform_inc( struct semantic* semantic, struct inc* inc,
@@ -1652,6 +1724,9 @@ static void test_subscript( struct semantic* semantic, struct expr_test* test,
 static void test_subscript_array( struct semantic* semantic,
    struct expr_test* test, struct result* result, struct result* lside,
    struct subscript* subscript ) {
+   if ( lside->type.ref->nullable ) {
+      note_null_check( semantic, lside );
+   }
    struct expr_test index;
    s_init_expr_test( &index, true, false );
    test_nested_expr( semantic, test, &index, subscript->index );
@@ -1680,8 +1755,12 @@ static void test_subscript_array( struct semantic* semantic,
    case SUBSCRIPTRESULT_STRUCT:
       result->data_origin = lside->data_origin;
       break;
-   case SUBSCRIPTRESULT_REF:
    case SUBSCRIPTRESULT_PRIMITIVE:
+      // Keep the origin, so writing the element marks the array as modified.
+      result->data_origin = lside->data_origin;
+      result->modifiable = true;
+      break;
+   case SUBSCRIPTRESULT_REF:
       result->modifiable = true;
    }
    result->usable = true;
@@ -1699,8 +1778,20 @@ static void test_subscript_array( struct semantic* semantic,
          result->folded = true;
       }
       break;
-   case SUBSCRIPTRESULT_REF:
    case SUBSCRIPTRESULT_PRIMITIVE:
+      // Note a constant element of a map array. If the array is never
+      // modified, codegen can push the initial value of the element.
+      if ( lside->folded && subscript->index->folded && ! out_of_bounds &&
+         lside->dim && lside->dim->length && lside->data_origin.var &&
+         ! lside->data_origin.structure_member &&
+         lside->data_origin.var->storage == STORAGE_MAP ) {
+         subscript->var = lside->data_origin.var;
+         subscript->offset = lside->value +
+            lside->dim->element_size * subscript->index->value;
+         ++subscript->var->folded_reads;
+      }
+      break;
+   case SUBSCRIPTRESULT_REF:
       break;
    default:
       S_UNREACHABLE( semantic );
@@ -1794,15 +1885,16 @@ static void test_access_struct( struct semantic* semantic,
    // Null check.
    if ( lside->type.ref->nullable ) {
       semantic->lib->uses_nullable_refs = true;
+      note_null_check( semantic, lside );
    }
 }
 
 static struct structure_member* get_structure_member(
    struct semantic* semantic, struct expr_test* test, struct access* access,
    struct result* lside ) {
-   struct name* name = t_extend_name( lside->type.structure->body,
-      access->name );
-   if ( ! ( name->object &&
+   struct name* name = t_find_name_atom( lside->type.structure->body,
+      access->atom );
+   if ( ! ( name && name->object &&
       name->object->node.type == NODE_STRUCTURE_MEMBER ) ) {
       if ( lside->type.structure->anon ) {
          s_diag( semantic, DIAG_POS_ERR, &access->pos,
@@ -1826,6 +1918,7 @@ static struct structure_member* get_structure_member(
          s_bail( semantic );
       }
       else {
+         semantic->dependency = name->object;
          test->undef_erred = true;
          longjmp( test->bail, 1 );
       }
@@ -1837,7 +1930,7 @@ static void test_access_ns( struct semantic* semantic,
    struct expr_test* test, struct access* access, struct result* lside,
    struct result* result ) {
    struct ns* ns = ( struct ns* ) lside->object;
-   struct object* object = s_get_ns_object( ns, access->name, NODE_NONE );
+   struct object* object = s_get_ns_object( ns, access->atom, NODE_NONE );
    if ( ! object ) {
       s_unknown_ns_object( semantic, ns, access->name, &access->pos );
       s_bail( semantic );
@@ -1849,6 +1942,7 @@ static void test_access_ns( struct semantic* semantic,
          s_bail( semantic );
       }
       else {
+         semantic->dependency = object;
          test->undef_erred = true;
          longjmp( test->bail, 1 );
       }
@@ -1934,7 +2028,7 @@ static void test_access_array( struct semantic* semantic,
    struct expr_test* test, struct access* access, struct result* lside,
    struct result* result ) {
    struct name* name = t_extend_name( semantic->task->array_name, "." );
-   name = t_extend_name( name, access->name );
+   name = t_extend_name_atom( name, access->atom );
    if ( ! name->object ) {
       s_diag( semantic, DIAG_POS_ERR, &access->pos,
          "`%s` not a member of the array type", access->name );
@@ -1966,6 +2060,7 @@ static void test_access_array( struct semantic* semantic,
    // Null check.
    if ( lside->type.ref->nullable ) {
       semantic->lib->uses_nullable_refs = true;
+      note_null_check( semantic, lside );
    }
 }
 
@@ -1973,7 +2068,7 @@ static void test_access_str( struct semantic* semantic,
    struct expr_test* test, struct access* access, struct result* lside,
    struct result* result ) {
    struct name* name = t_extend_name( semantic->task->str_name, "." );
-   name = t_extend_name( name, access->name );
+   name = t_extend_name_atom( name, access->atom );
    if ( ! name->object ) {
       s_diag( semantic, DIAG_POS_ERR, &access->pos,
          "`%s` not a member of the `str` type", access->name );
@@ -2037,7 +2132,17 @@ static void test_call( struct semantic* semantic, struct expr_test* expr_test,
       if ( operand.func->type == FUNC_USER ) {
          struct func_user* impl = operand.func->impl;
          if ( impl->nested ) {
-            add_nested_call( operand.func, call );
+            add_nested_call( semantic, operand.func, call );
+            // A nested function can assign the local variables of its
+            // enclosing function.
+            s_forget_non_null_refs( semantic );
+         }
+         if ( ! impl->nested && is_const_call( operand.func, call ) ) {
+            list_append( &semantic->const_calls, call );
+            s_record_call_use( semantic, call );
+         }
+         else {
+            s_record_use( semantic, &operand.func->object );
          }
       }
    }
@@ -2083,6 +2188,7 @@ static void test_call_operand( struct semantic* semantic,
    struct expr_test* expr_test, struct call_test* test, struct call* call,
    struct result* operand ) {
    init_result( operand );
+   operand->callee = true;
    test_suffix( semantic, expr_test, operand, call->operand );
    if ( operand->func ) {
       test->func = operand->func;
@@ -2247,17 +2353,46 @@ static void test_buildmsg( struct semantic* semantic,
    call->format_item = item;
 }
 
-static void add_nested_call( struct func* func, struct call* call ) {
+static void add_nested_call( struct semantic* semantic, struct func* func,
+   struct call* call ) {
    struct func_user* impl = func->impl;
    struct nested_call* nested = mem_alloc( sizeof( *nested ) );
    nested->next = impl->nested_calls;
+   nested->caller = NULL;
+   if ( semantic->func_test && semantic->func_test->func ) {
+      struct func_user* caller_impl = semantic->func_test->func->impl;
+      if ( caller_impl->local ) {
+         nested->caller = semantic->func_test->func;
+      }
+   }
    nested->id = 0;
    nested->prologue_jump = NULL;
    nested->return_point = NULL;
+   nested->tail = false;
    impl->nested_calls = call;
    call->nested_call = nested;
 }
 
+// Determines whether the call passes only constant numbers to a function
+// that returns a number. Such a call might be evaluated at compile time.
+static bool is_const_call( struct func* func, struct call* call ) {
+   struct func_user* impl = func->impl;
+   if ( impl->local || func->ref || func->return_spec == SPEC_VOID ||
+      func->return_spec == SPEC_STR ) {
+      return false;
+   }
+   struct list_iter i;
+   list_iterate( &call->args, &i );
+   while ( ! list_end( &i ) ) {
+      struct expr* arg = list_data( &i );
+      if ( ! arg->folded || arg->has_str ) {
+         return false;
+      }
+      list_next( &i );
+   }
+   return true;
+}
+
 static void test_call_args( struct semantic* semantic,
    struct expr_test* expr_test, struct call_test* test ) {
    struct call* call = test->call;
@@ -2410,20 +2545,6 @@ static void test_call_func( struct semantic* semantic, struct call_test* test,
    else if ( test->func->type == FUNC_DED ) {
       test_call_ded( semantic, test, call );
    }
-   // Determine if any function being tested is called recursively.
-   struct func_test* func_test = semantic->func_test;
-   while ( func_test && func_test->func != test->func ) {
-      func_test = func_test->parent;
-   }
-   if ( func_test ) {
-      struct func_test* end = func_test->parent;
-      func_test = semantic->func_test;
-      while ( func_test != end ) {
-         struct func_user* impl = func_test->func->impl;
-         impl->recursive = RECURSIVE_POSSIBLY;
-         func_test = func_test->parent;
-      }
-   }
    // Make sure the function can be constant-called.
    if ( test->call->constant ) {
       bool supported = ( test->func->type == FUNC_ASPEC ||
@@ -2493,6 +2614,14 @@ static void test_sure( struct semantic* semantic, struct expr_test* test,
       if ( sure->ref->nullable ) {
          sure->ref->nullable = false;
          semantic->lib->uses_nullable_refs = true;
+         if ( operand.name_usage ) {
+            if ( is_non_null_ref( semantic, operand.name_usage->object ) ) {
+               sure->already_safe = true;
+            }
+            else {
+               add_non_null_ref( semantic, operand.name_usage->object );
+            }
+         }
       }
       else {
          sure->already_safe = true;
@@ -2621,9 +2750,12 @@ static void test_name_usage( struct semantic* semantic,
    struct expr_test* expr_test, struct result* result,
    struct name_usage* usage ) {
    struct general_name_usage_test test;
-   init_general_name_usage_test( &test, &usage->pos, usage->text, NULL );
+   init_general_name_usage_test( &test, &usage->pos, usage->atom, NULL );
    test_general_name_usage( semantic, expr_test, result, &test );
    usage->object = test.object;
+   if ( is_tracked_ref( usage->object ) ) {
+      result->name_usage = usage;
+   }
 }
 
 static void test_qualified_name_usage( struct semantic* semantic,
@@ -2636,9 +2768,9 @@ static void test_qualified_name_usage( struct semantic* semantic,
 }
 
 static void init_general_name_usage_test( struct general_name_usage_test* test,
-   struct pos* pos, const char* text, struct path* path ) {
+   struct pos* pos, struct atom* name, struct path* path ) {
    test->path = path;
-   test->text = text;
+   test->name = name;
    test->pos = pos;
    test->object = NULL;
    test->qualified_name = ( path != NULL );
@@ -2653,7 +2785,7 @@ static void test_general_name_usage( struct semantic* semantic,
       struct follower follower;
       s_init_follower( &follower, test->path, NODE_NONE );
       s_follow_path( semantic, &follower );
-      test->text = follower.path->text;
+      test->name = follower.path->atom;
       test->pos = &follower.path->pos;
       object = follower.result.object;
    }
@@ -2661,13 +2793,13 @@ static void test_general_name_usage( struct semantic* semantic,
       // NOTE: Not sure anymore what the following if statement is for. Need to
       // look into it and explain it.
       if ( expr_test->name_offset ) {
-         struct name* name = t_extend_name( expr_test->name_offset,
-            test->text );
+         struct name* name = t_extend_name_atom( expr_test->name_offset,
+            test->name );
          object = name->object;
       }
       if ( ! object ) {
          struct object_search search;
-         s_init_object_search( &search, NODE_NONE, test->pos, test->text );
+         s_init_object_search( &search, NODE_NONE, test->pos, test->name );
          s_search_object( semantic, &search );
          object = search.object;
       }
@@ -2683,15 +2815,16 @@ static void test_general_name_usage( struct semantic* semantic,
       if ( semantic->trigger_err ) {
          if ( object ) {
             s_diag( semantic, DIAG_POS_ERR, test->pos,
-               "`%s` undefined", test->text );
+               "`%s` undefined", test->name->text );
          }
          else {
             s_diag( semantic, DIAG_POS_ERR, test->pos,
-               "`%s` not found", test->text );
+               "`%s` not found", test->name->text );
          }
          s_bail( semantic );
       }
       else {
+         semantic->dependency = object;
          expr_test->undef_erred = true;
          longjmp( expr_test->bail, 1 );
       }
@@ -2947,6 +3080,10 @@ static void select_var( struct semantic* semantic, struct result* result,
    result->complete = true;
    result->usable = true;
    var->used = true;
+   if ( var->storage == STORAGE_MAP ) {
+      s_record_use( semantic, &var->object );
+      ++var->reads;
+   }
 }
 
 static void select_param( struct semantic* semantic, struct result* result,
@@ -3033,6 +3170,9 @@ static void select_func( struct semantic* semantic, struct result* result,
       result->folded = true;
       result->complete = true;
       ++impl->usage;
+      if ( ! result->callee ) {
+         s_record_use( semantic, &func->object );
+      }
    }
    // When an action-special is not called, it decays into an integer value.
    // The value is the ID of the action-special.
@@ -3138,6 +3278,9 @@ static void test_strcpy( struct semantic* semantic, struct expr_test* test,
          "argument is not a one-dimensional int array" );
       s_bail( semantic );
    }
+   if ( arg.var ) {
+      arg.var->element_modified = true;
+   }
    // Array-offset.
    if ( call->array_offset ) {
       s_init_expr_test( &arg, true, false );
@@ -3199,6 +3342,9 @@ static void test_memcpy( struct semantic* semantic, struct expr_test* test,
          "destination not an array" );
       s_bail( semantic );
    }
+   if ( dst.var ) {
+      dst.var->element_modified = true;
+   }
    // Destination-offset.
    if ( call->destination_offset ) {
       struct expr_test arg;
@@ -3422,3 +3568,216 @@ static void test_null( struct result* result ) {
    result->usable = true;
    result->folded = true;
 }
+
+static bool is_tracked_ref( struct node* object ) {
+   if ( ! object ) {
+      return false;
+   }
+   switch ( object->type ) {
+   case NODE_VAR: {
+         struct var* var = ( struct var* ) object;
+         return ( var->ref && var->ref->nullable && ! var->dim &&
+            var->storage == STORAGE_LOCAL );
+      }
+   case NODE_PARAM: {
+         struct param* param = ( struct param* ) object;
+         return ( param->ref && param->ref->nullable );
+      }
+   default:
+      return false;
+   }
+}
+
+static bool is_non_null_ref( struct semantic* semantic, struct node* object ) {
+   if ( semantic->func_test ) {
+      struct list_iter i;
+      list_iterate( &semantic->func_test->non_null_refs, &i );
+      while ( ! list_end( &i ) ) {
+         if ( list_data( &i ) == object ) {
+            return true;
+         }
+         list_next( &i );
+      }
+   }
+   return false;
+}
+
+static void add_non_null_ref( struct semantic* semantic, struct node* object ) {
+   if ( semantic->func_test && ! is_non_null_ref( semantic, object ) ) {
+      list_append( &semantic->func_test->non_null_refs, object );
+   }
+}
+
+static void remove_non_null_ref( struct semantic* semantic,
+   struct node* object ) {
+   if ( is_non_null_ref( semantic, object ) ) {
+      struct list refs;
+      list_init( &refs );
+      struct list_iter i;
+      list_iterate( &semantic->func_test->non_null_refs, &i );
+      while ( ! list_end( &i ) ) {
+         if ( list_data( &i ) != object ) {
+            list_append( &refs, list_data( &i ) );
+         }
+         list_next( &i );
+      }
+      list_deinit( &semantic->func_test->non_null_refs );
+      semantic->func_test->non_null_refs = refs;
+   }
+}
+
+// A reference that passes a null check stays non-null until it is assigned
+// again, so the later checks of the reference can be skipped.
+static void note_null_check( struct semantic* semantic,
+   struct result* result ) {
+   if ( result->name_usage ) {
+      struct node* object = result->name_usage->object;
+      if ( is_non_null_ref( semantic, object ) ) {
+         result->name_usage->non_null = true;
+      }
+      else {
+         add_non_null_ref( semantic, object );
+      }
+   }
+}
+
+void s_forget_non_null_refs( struct semantic* semantic ) {
+   if ( semantic->func_test ) {
+      list_deinit( &semantic->func_test->non_null_refs );
+      list_init( &semantic->func_test->non_null_refs );
+   }
+}
+
+void s_save_non_null_refs( struct semantic* semantic, struct list* saved ) {
+   list_init( saved );
+   if ( semantic->func_test ) {
+      struct list_iter i;
+      list_iterate( &semantic->func_test->non_null_refs, &i );
+      while ( ! list_end( &i ) ) {
+         list_append( saved, list_data( &i ) );
+         list_next( &i );
+      }
+   }
+}
+
+void s_restore_non_null_refs( struct semantic* semantic, struct list* saved ) {
+   if ( semantic->func_test ) {
+      list_deinit( &semantic->func_test->non_null_refs );
+      semantic->func_test->non_null_refs = *saved;
+      list_init( saved );
+   }
+   else {
+      list_deinit( saved );
+   }
+}
+
+// Restores the saved references after code that might or might not have run.
+// A saved reference that the code assigned is no longer known to be non-null.
+void s_restore_surviving_non_null_refs( struct semantic* semantic,
+   struct list* saved ) {
+   if ( semantic->func_test ) {
+      struct list refs;
+      list_init( &refs );
+      struct list_iter i;
+      list_iterate( saved, &i );
+      while ( ! list_end( &i ) ) {
+         if ( is_non_null_ref( semantic, list_data( &i ) ) ) {
+            list_append( &refs, list_data( &i ) );
+         }
+         list_next( &i );
+      }
+      list_deinit( &semantic->func_test->non_null_refs );
+      semantic->func_test->non_null_refs = refs;
+   }
+   list_deinit( saved );
+}
+
+// Tells whether any of the references is no longer known to be non-null.
+static bool lost_non_null_refs( struct semantic* semantic,
+   struct list* refs ) {
+   struct list_iter i;
+   list_iterate( refs, &i );
+   while ( ! list_end( &i ) ) {
+      if ( ! is_non_null_ref( semantic, list_data( &i ) ) ) {
+         return true;
+      }
+      list_next( &i );
+   }
+   return false;
+}
+
+// Notes the references that are non-null when the condition has the
+// specified value.
+void s_assume_cond( struct semantic* semantic, struct expr* expr,
+   bool value ) {
+   assume_operand( semantic, expr->root, value );
+}
+
+void s_assume_non_null_var( struct semantic* semantic, struct var* var ) {
+   if ( is_tracked_ref( &var->object.node ) ) {
+      add_non_null_ref( semantic, &var->object.node );
+   }
+}
+
+static void assume_operand( struct semantic* semantic, struct node* node,
+   bool value ) {
+   switch ( node->type ) {
+   case NODE_PAREN:
+      assume_operand( semantic, ( ( struct paren* ) node )->inside, value );
+      break;
+   case NODE_UNARY: {
+         struct unary* unary = ( struct unary* ) node;
+         if ( unary->op == UOP_LOG_NOT ) {
+            assume_operand( semantic, unary->operand, ! value );
+         }
+      }
+      break;
+   case NODE_LOGICAL: {
+         struct logical* logical = ( struct logical* ) node;
+         if ( ( logical->op == LOP_AND ) == value ) {
+            if ( ! logical->rside_changes_refs ) {
+               assume_operand( semantic, logical->lside, value );
+            }
+            assume_operand( semantic, logical->rside, value );
+         }
+      }
+      break;
+   case NODE_BINARY: {
+         struct binary* binary = ( struct binary* ) node;
+         if ( ( binary->op == BOP_EQ || binary->op == BOP_NEQ ) &&
+            ( binary->op == BOP_NEQ ) == value ) {
+            struct name_usage* usage = NULL;
+            if ( binary->rside->type == NODE_NULL ) {
+               usage = get_tracked_usage( binary->lside );
+            }
+            else if ( binary->lside->type == NODE_NULL ) {
+               usage = get_tracked_usage( binary->rside );
+            }
+            if ( usage ) {
+               add_non_null_ref( semantic, usage->object );
+            }
+         }
+      }
+      break;
+   case NODE_NAME_USAGE:
+      if ( value && get_tracked_usage( node ) ) {
+         add_non_null_ref( semantic, ( ( struct name_usage* ) node )->object );
+      }
+      break;
+   default:
+      break;
+   }
+}
+
+static struct name_usage* get_tracked_usage( struct node* node ) {
+   while ( node->type == NODE_PAREN ) {
+      node = ( ( struct paren* ) node )->inside;
+   }
+   if ( node->type == NODE_NAME_USAGE ) {
+      struct name_usage* usage = ( struct name_usage* ) node;
+      if ( is_tracked_ref( usage->object ) ) {
+         return usage;
+      }
+   }
+   return NULL;
+}
@@ -1,4 +1,5 @@
 #include <string.h>
+#include <ctype.h>
 
 #include "phase.h"
 
@@ -25,6 +26,24 @@ struct ns_link_retriever {
    struct ns_link* link;
 };
 
+// Scripts grouped by number, or by case-folded name. The first script of a
+// group is the one chained in a bucket; the rest follow through `dup`.
+struct script_entry {
+   struct script* script;
+   struct script_entry* next;
+   struct script_entry* dup;
+   struct script_entry* dup_tail;
+   const char* name;
+   unsigned int hash;
+};
+
+struct script_table {
+   struct script_entry* entries;
+   struct script_entry** buckets;
+   int size;
+   int capacity;
+};
+
 static void init_worldglobal_vars( struct semantic* semantic );
 static void test_acs( struct semantic* semantic );
 static void test_module_acs( struct semantic* semantic, struct library* lib );
@@ -44,13 +63,17 @@ static void bind_structure( struct semantic* semantic,
    struct structure* structure );
 static void bind_var( struct semantic* semantic, struct var* var );
 static void bind_func( struct semantic* semantic, struct func* func );
-static void show_private_objects( struct semantic* semantic );
+static void set_private_layer( struct semantic* semantic,
+   struct library* lib );
+static void show_private_objects( struct semantic* semantic,
+   struct library* lib );
 static void show_enumeration( struct semantic* semantic,
    struct enumeration* enumeration );
 static void show_structure( struct semantic* semantic,
    struct structure* structure );
 static void show_namespace( struct ns_fragment* fragment );
-static void hide_private_objects( struct semantic* semantic );
+static void hide_private_objects( struct semantic* semantic,
+   struct library* lib );
 static void hide_enumeration( struct semantic* semantic,
    struct enumeration* enumeration );
 static void hide_structure( struct semantic* semantic,
@@ -80,6 +103,15 @@ static void test_all( struct semantic* semantic );
 static void test_lib( struct semantic* semantic, struct library* lib );
 static void test_namespace( struct semantic* semantic,
    struct ns_fragment* fragment );
+static struct object* find_waitable( struct object* dependency );
+static void wait_on( struct semantic* semantic, struct object* object,
+   struct object* dependency );
+static void wake_dependents( struct semantic* semantic,
+   struct object* object );
+static void requeue_all( struct semantic* semantic );
+static void requeue_lib( struct semantic* semantic, struct library* lib );
+static void requeue_namespace( struct semantic* semantic,
+   struct ns_fragment* fragment );
 static void test_nested_namespace( struct semantic* semantic,
    struct ns_fragment* fragment );
 static void test_nested_namespace_name( struct semantic* semantic,
@@ -92,9 +124,29 @@ static void test_objects_bodies_lib( struct semantic* semantic,
 static void test_objects_bodies_ns( struct semantic* semantic,
    struct ns_fragment* fragment );
 static void check_dup_scripts( struct semantic* semantic );
+static void init_script_table( struct script_table* table, int count );
+static void add_script_lib( struct semantic* semantic,
+   struct script_table* table, struct library* lib );
+static void add_script( struct semantic* semantic,
+   struct script_table* table, struct script* script );
+static struct script_entry* find_script( struct script_table* table,
+   struct script_entry* entry );
+static bool same_script_key( struct script_entry* entry,
+   struct script_entry* other );
+static void free_script_table( struct script_table* table );
 static void match_dup_script( struct semantic* semantic, struct script* script,
    struct script* prev_script, bool imported );
 static void assign_script_numbers( struct semantic* semantic );
+static void find_reachable_objects( struct semantic* semantic );
+static void reach_all_objects( struct semantic* semantic );
+static void reach_uses( struct list* uses, struct list* queue );
+static bool needs_storage( struct var* var );
+static void reach_object( struct object* object, struct list* queue );
+static void find_immutable_vars( struct semantic* semantic );
+static bool is_immutable_var( struct semantic* semantic, struct var* var );
+static struct list* get_uses( struct semantic* semantic );
+static void mark_uses( struct list* uses );
+static struct list** get_recorded_in( struct object* object );
 static void bind_private_name( struct name* name, struct object* object );
 static void bind_func_name( struct semantic* semantic, struct name* name,
    struct object* object );
@@ -117,6 +169,7 @@ void s_init( struct semantic* semantic, struct task* task ) {
    semantic->task = task;
    semantic->main_lib = task->library_main;
    semantic->lib = semantic->main_lib;
+   semantic->private_layer = NULL;
    semantic->ns = NULL;
    semantic->ns_fragment = NULL;
    semantic->scope = NULL;
@@ -125,12 +178,21 @@ void s_init( struct semantic* semantic, struct task* task ) {
    semantic->free_sweep = NULL;
    semantic->topfunc_test = NULL;
    semantic->func_test = NULL;
+   semantic->uses = NULL;
+   list_init( &semantic->root_uses );
+   semantic->marked_uses = NULL;
+   list_init( &semantic->const_calls );
+   semantic->ref_buckets = NULL;
+   semantic->ref_capacity = 0;
+   semantic->ref_size = 0;
    semantic->lang_limits = t_get_lang_limits( semantic->lib->lang );
    init_worldglobal_vars( semantic );
    s_init_type_info_scalar( &semantic->type_int, SPEC_INT );
+   semantic->dependency = NULL;
    semantic->depth = 0;
    semantic->retest_nss = false;
    semantic->resolved_objects = false;
+   semantic->waiting_objects = 0;
    semantic->trigger_err = false;
    semantic->in_localscope = false;
    semantic->strong_type = false;
@@ -203,6 +265,14 @@ void s_test( struct semantic* semantic ) {
          semantic->lang_limits->max_strings );
       s_bail( semantic );
    }
+   if ( semantic->task->options->optimize >= OPTIMIZE_BASIC ) {
+      find_immutable_vars( semantic );
+      s_eval_const_calls( semantic );
+      find_reachable_objects( semantic );
+   }
+   else {
+      reach_all_objects( semantic );
+   }
 }
 
 static void test_acs( struct semantic* semantic ) {
@@ -296,6 +366,7 @@ static void test_bcs( struct semantic* semantic ) {
    perform_usings( semantic );
    test_objects( semantic );
    test_objects_bodies( semantic );
+   set_private_layer( semantic, NULL );
    check_dup_scripts( semantic );
    assign_script_numbers( semantic );
    // TODO: Refactor this.
@@ -341,12 +412,12 @@ static void bind_names( struct semantic* semantic ) {
    while ( ! list_end( &i ) ) {
       semantic->lib = list_data( &i );
       bind_namespace( semantic, semantic->lib->upmost_ns_fragment );
-      hide_private_objects( semantic );
+      hide_private_objects( semantic, semantic->lib );
       list_next( &i );
    }
    semantic->lib = semantic->main_lib;
    bind_namespace( semantic, semantic->lib->upmost_ns_fragment );
-   hide_private_objects( semantic );
+   hide_private_objects( semantic, semantic->lib );
 }
 
 static void bind_namespace( struct semantic* semantic,
@@ -473,9 +544,27 @@ static void bind_func( struct semantic* semantic, struct func* func ) {
    s_bind_name( semantic, func->name, &func->object );
 }
 
-static void show_private_objects( struct semantic* semantic ) {
+// Makes the private objects of the library visible, and hides those of the
+// library that was visible before. The names are only rebound when a
+// different library becomes active, so the passes over a single library do
+// not rebind anything.
+static void set_private_layer( struct semantic* semantic,
+   struct library* lib ) {
+   if ( lib != semantic->private_layer ) {
+      if ( semantic->private_layer ) {
+         hide_private_objects( semantic, semantic->private_layer );
+      }
+      if ( lib ) {
+         show_private_objects( semantic, lib );
+      }
+      semantic->private_layer = lib;
+   }
+}
+
+static void show_private_objects( struct semantic* semantic,
+   struct library* lib ) {
    struct list_iter i;
-   list_iterate( &semantic->lib->private_objects, &i );
+   list_iterate( &lib->private_objects, &i );
    while ( ! list_end( &i ) ) {
       struct object* object = list_data( &i );
       switch ( object->node.type ) {
@@ -550,9 +639,10 @@ static void show_namespace( struct ns_fragment* fragment ) {
    }
 }
 
-static void hide_private_objects( struct semantic* semantic ) {
+static void hide_private_objects( struct semantic* semantic,
+   struct library* lib ) {
    struct list_iter i;
-   list_iterate( &semantic->lib->private_objects, &i );
+   list_iterate( &lib->private_objects, &i );
    while ( ! list_end( &i ) ) {
       struct object* object = list_data( &i );
       switch ( object->node.type ) {
@@ -718,7 +808,7 @@ static void import_item( struct semantic* semantic, struct ns* ns,
    struct object* object;
    switch ( item->type ) {
    case USINGITEM_STRUCT:
-      object = s_get_ns_object( ns, item->name, NODE_STRUCTURE );
+      object = s_get_ns_object( ns, item->atom, NODE_STRUCTURE );
       if ( ! object ) {
          s_diag( semantic, DIAG_POS_ERR, &item->pos,
             "struct `%s` not found", item->name );
@@ -726,7 +816,7 @@ static void import_item( struct semantic* semantic, struct ns* ns,
       }
       break;
    case USINGITEM_ENUM:
-      object = s_get_ns_object( ns, item->name, NODE_ENUMERATION );
+      object = s_get_ns_object( ns, item->atom, NODE_ENUMERATION );
       if ( ! object ) {
          s_diag( semantic, DIAG_POS_ERR, &item->pos,
             "enum `%s` not found", item->name );
@@ -739,7 +829,7 @@ static void import_item( struct semantic* semantic, struct ns* ns,
       }
       break;
    default:
-      object = s_get_ns_object( ns, item->name, NODE_NONE );
+      object = s_get_ns_object( ns, item->atom, NODE_NONE );
       if ( ! object ) {
          s_unknown_ns_object( semantic, ns, item->name, &item->pos );
          s_bail( semantic );
@@ -757,7 +847,7 @@ static void import_item( struct semantic* semantic, struct ns* ns,
    default:
       body = semantic->ns->body;
    }
-   struct name* name = t_extend_name( body, item->usage_name );
+   struct name* name = t_extend_name_atom( body, item->usage_atom );
    // Duplicate imports are allowed as long as both names refer to the same
    // object.
    if ( name->object && name->object->node.type == NODE_ALIAS ) {
@@ -817,7 +907,7 @@ void s_follow_path( struct semantic* semantic, struct follower* follower ) {
       else {
          struct object_search search;
          s_init_object_search( &search, NODE_NAMESPACE, &path->pos,
-            path->text );
+            path->atom );
          s_search_object( semantic, &search );
          object = search.object;
          if ( ! object ) {
@@ -839,7 +929,7 @@ void s_follow_path( struct semantic* semantic, struct follower* follower ) {
       }
       // Middle.
       while ( path->next ) {
-         object = s_get_ns_object( ns, path->text, NODE_NONE );
+         object = s_get_ns_object( ns, path->atom, NODE_NONE );
          if ( ! object ) {
             s_diag( semantic, DIAG_POS_ERR, &path->pos,
                "`%s` not found", path->text );
@@ -854,7 +944,7 @@ void s_follow_path( struct semantic* semantic, struct follower* follower ) {
          path = path->next;
       }
       // Tail.
-      object = s_get_ns_object( ns, path->text, follower->requested_node );
+      object = s_get_ns_object( ns, path->atom, follower->requested_node );
    }
    // Single-part path.
    else {
@@ -867,7 +957,7 @@ void s_follow_path( struct semantic* semantic, struct follower* follower ) {
       else {
          struct object_search search;
          s_init_object_search( &search, follower->requested_node, &path->pos,
-            path->text );
+            path->atom );
          s_search_object( semantic, &search );
          object = search.object;
       }
@@ -903,7 +993,7 @@ void s_follow_path( struct semantic* semantic, struct follower* follower ) {
 }
 
 void s_init_object_search( struct object_search* search, int requested_node,
-   struct pos* pos, const char* name ) {
+   struct pos* pos, struct atom* name ) {
    search->name = name;
    search->pos = pos;
    search->object = NULL;
@@ -1010,11 +1100,11 @@ static struct object* search_in_ns_links( struct semantic* semantic,
    if ( links.link ) {
       s_diag( semantic, DIAG_POS_ERR, search->pos,
          "multiple instances of `%s` found (you must be more specific)",
-         search->name );
+         search->name->text );
       s_diag( semantic, DIAG_POS | DIAG_NOTE, &link->pos,
          "through this using directive..." );
       s_diag( semantic, DIAG_POS, &object->pos,
-         "`%s` refers to the object found here", search->name );
+         "`%s` refers to the object found here", search->name->text );
       while ( links.link ) {
          struct object* dup_object = search_in_ns_direct( semantic, search,
             links.link->ns );
@@ -1022,7 +1112,8 @@ static struct object* search_in_ns_links( struct semantic* semantic,
             s_diag( semantic, DIAG_POS | DIAG_NOTE, &links.link->pos,
                "and through this using directive..." );
             s_diag( semantic, DIAG_POS, &dup_object->pos,
-               "`%s` refers to the object found here", search->name );
+               "`%s` refers to the object found here",
+               search->name->text );
          }
          next_ns_link( &links );
       }
@@ -1033,16 +1124,16 @@ static struct object* search_in_ns_links( struct semantic* semantic,
 
 // Retrieves an object from a namespace. If the object is an alias, it is first
 // followed.
-struct object* s_get_ns_object( struct ns* ns, const char* object_name,
+struct object* s_get_ns_object( struct ns* ns, struct atom* object_name,
    int requested_node ) {
    return follow_alias( s_get_direct_ns_object( ns, object_name,
       requested_node ) );
 }
 
 // Retrieves an object from a namespace, including aliases.
-struct object* s_get_direct_ns_object( struct ns* ns, const char* object_name,
-   int requested_node ) {
-   struct name* name = t_extend_name( get_body( ns, requested_node ),
+struct object* s_get_direct_ns_object( struct ns* ns,
+   struct atom* object_name, int requested_node ) {
+   struct name* name = t_extend_name_atom( get_body( ns, requested_node ),
       object_name );
    if ( name->object ) {
       struct object* object = name->object;
@@ -1059,9 +1150,9 @@ struct object* s_get_direct_ns_object( struct ns* ns, const char* object_name,
 // Retrieves an object from local scope. If the object is an alias, it is first
 // followed.
 struct object* s_get_local_object( struct semantic* semantic,
-   const char* object_name, int requested_node ) {
-   struct name* name = t_extend_name( get_body( semantic->ns, requested_node ),
-      object_name );
+   struct atom* object_name, int requested_node ) {
+   struct name* name = t_extend_name_atom( get_body( semantic->ns,
+      requested_node ), object_name );
    if ( name->object && name->object->depth > 0 ) {
       return follow_alias( name->object );
    }
@@ -1073,9 +1164,9 @@ struct object* s_get_local_object( struct semantic* semantic,
 // object in the current namespace is returned. If the object is an alias, it
 // is first followed.
 struct object* s_get_object( struct semantic* semantic,
-   const char* object_name, int requested_node ) {
-   struct name* name = t_extend_name( get_body( semantic->ns, requested_node ),
-      object_name );
+   struct atom* object_name, int requested_node ) {
+   struct name* name = t_extend_name_atom( get_body( semantic->ns,
+      requested_node ), object_name );
    return follow_alias( name->object );
 }
 
@@ -1099,16 +1190,30 @@ static struct object* follow_alias( struct object* object ) {
    return object;
 }
 
+// An object that fails to resolve because of another unresolved object waits
+// on that object. It is not retested until that object gets resolved.
 static void test_objects( struct semantic* semantic ) {
+   bool requeued = false;
    while ( true ) {
       semantic->retest_nss = false;
       semantic->resolved_objects = false;
       test_all( semantic );
       if ( semantic->retest_nss ) {
          // Continue resolving as long as something got resolved. If nothing
-         // gets resolved in the previous run, then nothing can be resolved
-         // anymore. So report errors.
-         if ( ! semantic->resolved_objects ) {
+         // gets resolved in the previous run, first retest the waiting
+         // objects, in case they were waiting on an object that got resolved
+         // without notice. If still nothing gets resolved, then nothing can
+         // be resolved anymore. So report errors. Requeueing puts the objects
+         // back in declaration order, which error reporting relies on.
+         if ( semantic->resolved_objects ) {
+            requeued = false;
+         }
+         else if ( semantic->waiting_objects && ! requeued ) {
+            requeue_all( semantic );
+            requeued = true;
+         }
+         else {
+            requeue_all( semantic );
             semantic->trigger_err = true;
          }
       }
@@ -1131,9 +1236,8 @@ static void test_all( struct semantic* semantic ) {
 static void test_lib( struct semantic* semantic, struct library* lib ) {
    struct library* prev_lib = semantic->lib;
    semantic->lib = lib;
-   show_private_objects( semantic );
+   set_private_layer( semantic, lib );
    test_namespace( semantic, lib->upmost_ns_fragment );
-   hide_private_objects( semantic );
    semantic->lib = prev_lib;
 }
 
@@ -1142,22 +1246,29 @@ static void test_namespace( struct semantic* semantic,
    semantic->ns = fragment->ns;
    semantic->ns_fragment = fragment;
    semantic->strong_type = fragment->strict;
-   struct object* object = fragment->unresolved;
-   fragment->unresolved = NULL;
-   fragment->unresolved_tail = NULL;
+   struct object* object = fragment->ready;
+   fragment->ready = NULL;
+   fragment->ready_tail = NULL;
    while ( object ) {
-      struct object* next_object = object->next;
-      object->next = NULL;
+      struct object* next_object = object->next_ready;
+      semantic->dependency = NULL;
       test_namespace_object( semantic, object );
       if ( object->resolved ) {
          semantic->resolved_objects = true;
+         wake_dependents( semantic, object );
+      }
+      // A namespace fragment waits on the objects inside it, not on a single
+      // object.
+      else if ( object->node.type != NODE_NAMESPACEFRAGMENT &&
+         find_waitable( semantic->dependency ) ) {
+         wait_on( semantic, object, find_waitable( semantic->dependency ) );
       }
       else {
-         t_append_unresolved_namespace_object( fragment, object );
+         t_queue_unresolved_namespace_object( fragment, object );
       }
       object = next_object;
    }
-   if ( ! fragment->unresolved ) {
+   if ( ! fragment->ready && ! fragment->waiting ) {
       fragment->object.resolved = true;
    }
    else {
@@ -1165,6 +1276,88 @@ static void test_namespace( struct semantic* semantic,
    }
 }
 
+// Returns the object to wait on for the dependency to get resolved. Only an
+// object that is itself in a queue can be waited on, since it wakes its
+// dependents when it gets resolved.
+static struct object* find_waitable( struct object* dependency ) {
+   // An enumerator gets resolved along with its enumeration.
+   if ( dependency && dependency->node.type == NODE_ENUMERATOR ) {
+      struct enumerator* enumerator = ( struct enumerator* ) dependency;
+      dependency = enumerator->enumeration ?
+         &enumerator->enumeration->object : NULL;
+   }
+   if ( dependency && dependency->fragment && ! dependency->resolved ) {
+      return dependency;
+   }
+   return NULL;
+}
+
+static void wait_on( struct semantic* semantic, struct object* object,
+   struct object* dependency ) {
+   object->dependency = dependency;
+   object->next_ready = dependency->dependents;
+   dependency->dependents = object;
+   ++object->fragment->waiting;
+   ++semantic->waiting_objects;
+}
+
+// Moves the objects waiting on the resolved object back to the queues of their
+// fragments.
+static void wake_dependents( struct semantic* semantic,
+   struct object* object ) {
+   struct object* dependent = object->dependents;
+   object->dependents = NULL;
+   while ( dependent ) {
+      struct object* next_dependent = dependent->next_ready;
+      dependent->dependency = NULL;
+      --dependent->fragment->waiting;
+      --semantic->waiting_objects;
+      t_queue_unresolved_namespace_object( dependent->fragment, dependent );
+      dependent = next_dependent;
+   }
+}
+
+// Rebuilds the queue of every fragment from its unresolved objects, in
+// declaration order, and stops all waiting.
+static void requeue_all( struct semantic* semantic ) {
+   struct list_iter i;
+   list_iterate( &semantic->main_lib->dynamic_bcs, &i );
+   while ( ! list_end( &i ) ) {
+      requeue_lib( semantic, list_data( &i ) );
+      list_next( &i );
+   }
+   requeue_lib( semantic, semantic->main_lib );
+   semantic->waiting_objects = 0;
+}
+
+static void requeue_lib( struct semantic* semantic, struct library* lib ) {
+   requeue_namespace( semantic, lib->upmost_ns_fragment );
+}
+
+static void requeue_namespace( struct semantic* semantic,
+   struct ns_fragment* fragment ) {
+   struct object* object = fragment->unresolved;
+   fragment->unresolved = NULL;
+   fragment->unresolved_tail = NULL;
+   fragment->ready = NULL;
+   fragment->ready_tail = NULL;
+   fragment->waiting = 0;
+   while ( object ) {
+      struct object* next_object = object->next;
+      object->next = NULL;
+      object->dependency = NULL;
+      object->dependents = NULL;
+      if ( ! object->resolved ) {
+         if ( object->node.type == NODE_NAMESPACEFRAGMENT ) {
+            requeue_namespace( semantic,
+               ( struct ns_fragment* ) object );
+         }
+         t_append_unresolved_namespace_object( fragment, object );
+      }
+      object = next_object;
+   }
+}
+
 static void test_nested_namespace( struct semantic* semantic,
    struct ns_fragment* fragment ) {
    struct ns_fragment* parent_fragment = semantic->ns_fragment;
@@ -1239,9 +1432,8 @@ static void test_objects_bodies_lib( struct semantic* semantic,
    struct library* lib ) {
    struct library* prev_lib = semantic->lib;
    semantic->lib = lib;
-   show_private_objects( semantic );
+   set_private_layer( semantic, lib );
    test_objects_bodies_ns( semantic, lib->upmost_ns_fragment );
-   hide_private_objects( semantic );
    semantic->lib = prev_lib;
 }
 
@@ -1285,33 +1477,135 @@ static void test_objects_bodies_ns( struct semantic* semantic,
    semantic->strong_type = parent_fragment->strict;
 }
 
+// The diagnostics are reported in the same order as a pairwise comparison of
+// every script: for each script of the main library, a duplicate found later
+// in the main library is an error, and then every match in an imported
+// library is a warning.
 static void check_dup_scripts( struct semantic* semantic ) {
+   struct script_table table;
+   init_script_table( &table, list_size( &semantic->main_lib->scripts ) );
+   add_script_lib( semantic, &table, semantic->main_lib );
+   int imported_count = 0;
    struct list_iter i;
-   list_iterate( &semantic->main_lib->scripts, &i );
+   list_iterate( &semantic->main_lib->dynamic, &i );
    while ( ! list_end( &i ) ) {
-      struct list_iter k = i;
-      list_next( &k );
-      while ( ! list_end( &k ) ) {
-         match_dup_script( semantic, list_data( &k ), list_data( &i ), false );
-         list_next( &k );
+      struct library* lib = list_data( &i );
+      imported_count += list_size( &lib->scripts );
+      list_next( &i );
+   }
+   struct script_table imported_table;
+   init_script_table( &imported_table, imported_count );
+   list_iterate( &semantic->main_lib->dynamic, &i );
+   while ( ! list_end( &i ) ) {
+      add_script_lib( semantic, &imported_table, list_data( &i ) );
+      list_next( &i );
+   }
+   for ( int k = 0; k < table.size; ++k ) {
+      struct script_entry* entry = &table.entries[ k ];
+      // Only the first script of a group can see a later duplicate before an
+      // earlier script does.
+      if ( find_script( &table, entry ) == entry && entry->dup ) {
+         match_dup_script( semantic, entry->dup->script, entry->script,
+            false );
       }
       // Check for duplicates in an imported library.
-      struct list_iter j;
-      list_iterate( &semantic->main_lib->dynamic, &j );
-      while ( ! list_end( &j ) ) {
-         struct library* lib = list_data( &j );
-         list_iterate( &lib->scripts, &k );
-         while ( ! list_end( &k ) ) {
-            match_dup_script( semantic, list_data( &i ), list_data( &k ),
-               true );
-            list_next( &k );
-         }
-         list_next( &j );
+      struct script_entry* imported = find_script( &imported_table, entry );
+      while ( imported ) {
+         match_dup_script( semantic, entry->script, imported->script, true );
+         imported = imported->dup;
       }
+   }
+   free_script_table( &imported_table );
+   free_script_table( &table );
+}
+
+static void init_script_table( struct script_table* table, int count ) {
+   table->capacity = 16;
+   while ( table->capacity < count * 2 ) {
+      table->capacity *= 2;
+   }
+   table->entries = mem_alloc( sizeof( *table->entries ) * ( count + 1 ) );
+   table->buckets = mem_alloc( sizeof( *table->buckets ) * table->capacity );
+   memset( table->buckets, 0,
+      sizeof( *table->buckets ) * table->capacity );
+   table->size = 0;
+}
+
+static void add_script_lib( struct semantic* semantic,
+   struct script_table* table, struct library* lib ) {
+   struct list_iter i;
+   list_iterate( &lib->scripts, &i );
+   while ( ! list_end( &i ) ) {
+      add_script( semantic, table, list_data( &i ) );
       list_next( &i );
    }
 }
 
+static void add_script( struct semantic* semantic,
+   struct script_table* table, struct script* script ) {
+   struct script_entry* entry = &table->entries[ table->size ];
+   ++table->size;
+   entry->script = script;
+   entry->next = NULL;
+   entry->dup = NULL;
+   entry->dup_tail = entry;
+   entry->name = NULL;
+   if ( script->named_script ) {
+      entry->name = t_lookup_string( semantic->task,
+         script->number->value )->value;
+      entry->hash = t_hash_text( entry->name, strlen( entry->name ),
+         true );
+   }
+   else {
+      entry->hash = ( unsigned int ) script->number->value;
+   }
+   struct script_entry* head = find_script( table, entry );
+   if ( head ) {
+      head->dup_tail->dup = entry;
+      head->dup_tail = entry;
+   }
+   else {
+      int index = entry->hash & ( table->capacity - 1 );
+      entry->next = table->buckets[ index ];
+      table->buckets[ index ] = entry;
+   }
+}
+
+// Finds the first script, in the table, with the same number or name as the
+// given script.
+static struct script_entry* find_script( struct script_table* table,
+   struct script_entry* entry ) {
+   struct script_entry* head =
+      table->buckets[ entry->hash & ( table->capacity - 1 ) ];
+   while ( head && ! same_script_key( head, entry ) ) {
+      head = head->next;
+   }
+   return head;
+}
+
+static bool same_script_key( struct script_entry* entry,
+   struct script_entry* other ) {
+   if ( entry->hash != other->hash ) {
+      return false;
+   }
+   else if ( entry->script->named_script && other->script->named_script ) {
+      return ( strcasecmp( entry->name, other->name ) == 0 );
+   }
+   else if ( ! entry->script->named_script &&
+      ! other->script->named_script ) {
+      return ( entry->script->number->value ==
+         other->script->number->value );
+   }
+   else {
+      return false;
+   }
+}
+
+static void free_script_table( struct script_table* table ) {
+   mem_free( table->buckets );
+   mem_free( table->entries );
+}
+
 static void match_dup_script( struct semantic* semantic, struct script* script,
    struct script* prev_script, bool imported ) {
    // Script names.
@@ -1375,6 +1669,177 @@ static void assign_script_numbers( struct semantic* semantic ) {
    }
 }
 
+// Finds the functions and map variables that can be reached from a script or
+// an exported object. The rest are not written to the object file.
+static void find_reachable_objects( struct semantic* semantic ) {
+   struct list queue;
+   list_init( &queue );
+   reach_uses( &semantic->root_uses, &queue );
+   if ( semantic->main_lib->importable ) {
+      struct list_iter i;
+      list_iterate( &semantic->main_lib->funcs, &i );
+      while ( ! list_end( &i ) ) {
+         struct func* func = list_data( &i );
+         if ( ! func->hidden ) {
+            reach_object( &func->object, &queue );
+         }
+         list_next( &i );
+      }
+      list_iterate( &semantic->main_lib->vars, &i );
+      while ( ! list_end( &i ) ) {
+         struct var* var = list_data( &i );
+         if ( ! var->hidden ) {
+            reach_object( &var->object, &queue );
+         }
+         list_next( &i );
+      }
+   }
+   while ( list_size( &queue ) > 0 ) {
+      struct object* object = list_shift( &queue );
+      if ( object->node.type == NODE_VAR ) {
+         struct var* var = ( struct var* ) object;
+         reach_uses( &var->uses, &queue );
+      }
+      else {
+         struct func* func = ( struct func* ) object;
+         struct func_user* impl = func->impl;
+         reach_uses( &impl->uses, &queue );
+      }
+   }
+}
+
+// Without optimization, every object of the main library is written, along
+// with the imported objects that are used.
+static void reach_all_objects( struct semantic* semantic ) {
+   struct list_iter i;
+   list_iterate( &semantic->main_lib->funcs, &i );
+   while ( ! list_end( &i ) ) {
+      struct func* func = list_data( &i );
+      struct func_user* impl = func->impl;
+      impl->reachable = true;
+      list_next( &i );
+   }
+   list_iterate( &semantic->main_lib->vars, &i );
+   while ( ! list_end( &i ) ) {
+      struct var* var = list_data( &i );
+      var->reachable = true;
+      list_next( &i );
+   }
+   list_iterate( &semantic->main_lib->dynamic, &i );
+   while ( ! list_end( &i ) ) {
+      struct library* lib = list_data( &i );
+      struct list_iter k;
+      list_iterate( &lib->funcs, &k );
+      while ( ! list_end( &k ) ) {
+         struct func* func = list_data( &k );
+         struct func_user* impl = func->impl;
+         impl->reachable = ( impl->usage > 0 );
+         list_next( &k );
+      }
+      list_iterate( &lib->vars, &k );
+      while ( ! list_end( &k ) ) {
+         struct var* var = list_data( &k );
+         var->reachable = var->used;
+         list_next( &k );
+      }
+      list_next( &i );
+   }
+   list_iterate( &semantic->main_lib->external_funcs, &i );
+   while ( ! list_end( &i ) ) {
+      struct func* func = list_data( &i );
+      struct func_user* impl = func->impl;
+      impl->reachable = ( impl->usage > 0 );
+      list_next( &i );
+   }
+   list_iterate( &semantic->main_lib->external_vars, &i );
+   while ( ! list_end( &i ) ) {
+      struct var* var = list_data( &i );
+      var->reachable = var->used;
+      list_next( &i );
+   }
+}
+
+static void reach_uses( struct list* uses, struct list* queue ) {
+   struct list_iter i;
+   list_iterate( uses, &i );
+   while ( ! list_end( &i ) ) {
+      struct node* node = list_data( &i );
+      // A call evaluated at compile time does not need the called function.
+      if ( node->type == NODE_CALL ) {
+         struct call* call = ( struct call* ) node;
+         if ( ! call->folded ) {
+            reach_object( &call->func->object, queue );
+         }
+      }
+      else {
+         reach_object( ( struct object* ) node, queue );
+      }
+      list_next( &i );
+   }
+}
+
+static void reach_object( struct object* object, struct list* queue ) {
+   if ( object->node.type == NODE_VAR ) {
+      struct var* var = ( struct var* ) object;
+      if ( ! var->reachable && needs_storage( var ) ) {
+         var->reachable = true;
+         list_append( queue, object );
+      }
+   }
+   else {
+      struct func* func = ( struct func* ) object;
+      struct func_user* impl = func->impl;
+      if ( ! impl->reachable ) {
+         impl->reachable = true;
+         list_append( queue, object );
+      }
+   }
+}
+
+// When every read of an immutable variable is replaced, the variable needs no
+// storage.
+static bool needs_storage( struct var* var ) {
+   return ( ! var->immutable ||
+      ( var->dim && var->folded_reads != var->reads ) );
+}
+
+// Finds the map variables that are never written after initialization.
+// Reading such a variable, or a constant element of such an array, can be
+// replaced with the initial value.
+static void find_immutable_vars( struct semantic* semantic ) {
+   struct list_iter i;
+   list_iterate( &semantic->main_lib->vars, &i );
+   while ( ! list_end( &i ) ) {
+      struct var* var = list_data( &i );
+      if ( is_immutable_var( semantic, var ) ) {
+         var->immutable = true;
+      }
+      list_next( &i );
+   }
+}
+
+static bool is_immutable_var( struct semantic* semantic, struct var* var ) {
+   // Other modules can write an exported variable.
+   if ( ! ( var->hidden || ! semantic->main_lib->importable ) ) {
+      return false;
+   }
+   if ( var->storage != STORAGE_MAP || var->structure || var->ref ||
+      var->modified || var->element_modified || var->addr_taken ) {
+      return false;
+   }
+   // A number computed from a string, as in an ACS initializer, would lose the
+   // tagging of library strings when pushed as a plain number.
+   struct value* value = var->value;
+   while ( value ) {
+      if ( ! ( ( value->type == VALUE_EXPR && ! value->expr->has_str ) ||
+         value->type == VALUE_STRING ) ) {
+         return false;
+      }
+      value = value->next;
+   }
+   return true;
+}
+
 void s_add_scope( struct semantic* semantic, bool func_scope ) {
    struct scope* scope;
    if ( semantic->free_scope ) {
@@ -1442,6 +1907,69 @@ static void bind_private_name( struct name* name, struct object* object ) {
 }
 
 // Local scope.
+// Records a use of a map variable or user function by the script, function,
+// or variable being tested. An object is listed once: it remembers the last
+// list it was added to, and when recording moves to another list, the objects
+// already in that list are marked again.
+void s_record_use( struct semantic* semantic, struct object* object ) {
+   struct list* uses = get_uses( semantic );
+   if ( uses != semantic->marked_uses ) {
+      mark_uses( uses );
+      semantic->marked_uses = uses;
+   }
+   struct list** recorded_in = get_recorded_in( object );
+   if ( *recorded_in != uses ) {
+      list_append( uses, object );
+      *recorded_in = uses;
+   }
+}
+
+static void mark_uses( struct list* uses ) {
+   struct list_iter i;
+   list_iterate( uses, &i );
+   while ( ! list_end( &i ) ) {
+      struct node* node = list_data( &i );
+      if ( node->type != NODE_CALL ) {
+         *get_recorded_in( ( struct object* ) node ) = uses;
+      }
+      list_next( &i );
+   }
+}
+
+static struct list** get_recorded_in( struct object* object ) {
+   if ( object->node.type == NODE_VAR ) {
+      struct var* var = ( struct var* ) object;
+      return &var->recorded_in;
+   }
+   else {
+      struct func* func = ( struct func* ) object;
+      struct func_user* impl = func->impl;
+      return &impl->recorded_in;
+   }
+}
+
+// Records a call that might be evaluated at compile time. The called function
+// is used only when the call is left for run time.
+void s_record_call_use( struct semantic* semantic, struct call* call ) {
+   list_append( get_uses( semantic ), call );
+}
+
+static struct list* get_uses( struct semantic* semantic ) {
+   struct list* uses = &semantic->root_uses;
+   if ( semantic->topfunc_test ) {
+      // Nested functions are written along with the enclosing function, so
+      // their uses are the uses of the enclosing function.
+      if ( semantic->topfunc_test->func ) {
+         struct func_user* impl = semantic->topfunc_test->func->impl;
+         uses = &impl->uses;
+      }
+   }
+   else if ( semantic->uses ) {
+      uses = semantic->uses;
+   }
+   return uses;
+}
+
 void s_bind_local_name( struct semantic* semantic, struct name* name,
    struct object* object, bool block_scope ) {
    if ( block_scope ) {
@@ -1524,7 +2052,7 @@ static void insert_namespace_link( struct semantic* semantic,
    else {
       link->next = semantic->ns->links;
       semantic->ns->links = link;
-   }
+      }
 }
 
 static void init_ns_link_retriever( struct semantic* semantic,
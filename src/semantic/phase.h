@@ -15,7 +15,7 @@ struct follower {
 };
 
 struct object_search {
-   const char* name;
+   struct atom* name;
    struct pos* pos;
    struct object* object;
    int requested_node;
@@ -46,6 +46,9 @@ struct func_test {
    struct func_test* parent;
    struct script* script;
    struct buildmsg* enclosing_buildmsg;
+   // Local reference variables and parameters known to be non-null at the
+   // current point of the body.
+   struct list non_null_refs;
 };
 
 struct stmt_test {
@@ -55,8 +58,14 @@ struct stmt_test {
    struct jump* jump_break;
    struct jump* jump_continue;
    struct type_info cond_type;
+   // Non-default cases of a switch statement, in the order they appear.
+   struct list cases;
    // Number of non-default cases found for a switch statement.
    int num_cases;
+   // The same cases, hashed by value. Used to find a duplicate case as soon
+   // as it is tested.
+   struct case_label** case_buckets;
+   int case_capacity;
    enum {
       FLOW_GOING,
       FLOW_BREAKING,
@@ -137,6 +146,9 @@ struct semantic {
    struct task* task;
    struct library* main_lib;
    struct library* lib;
+   // Library whose private objects are currently bound to their names. NULL
+   // when no private objects are visible.
+   struct library* private_layer;
    struct ns* ns;
    struct ns_fragment* ns_fragment;
    struct scope* scope;
@@ -145,12 +157,31 @@ struct semantic {
    struct sweep* free_sweep;
    struct func_test* topfunc_test;
    struct func_test* func_test;
+   // Uses of the object being tested outside of a script or function. Uses
+   // with no such object are found in `root_uses`.
+   struct list* uses;
+   struct list root_uses;
+   // List of uses that the objects were last marked for.
+   struct list* marked_uses;
+   // Calls to user functions whose arguments are all constant.
+   struct list const_calls;
+   // Canonical reference types. Structurally equal reference chains taken
+   // from expression types are interned here, so they share one immutable
+   // chain and compare equal by pointer.
+   struct canonical_ref** ref_buckets;
+   int ref_capacity;
+   int ref_size;
    const struct lang_limits* lang_limits;
    struct var* world_vars[ MAX_WORLD_VARS ];
    struct var* world_arrays[ MAX_WORLD_VARS ];
    struct var* global_vars[ MAX_GLOBAL_VARS ];
    struct var* global_arrays[ MAX_GLOBAL_VARS ];
    struct type_info type_int;
+   // Unresolved object that stopped the resolution of the namespace object
+   // being tested.
+   struct object* dependency;
+   // Number of objects waiting on another object.
+   int waiting_objects;
    int depth;
    int lang;
    bool retest_nss;
@@ -193,6 +224,14 @@ void s_init_expr_test_enumerator( struct expr_test* test,
    struct enumeration* enumeration );
 void s_test_expr( struct semantic* semantic, struct expr_test*, struct expr* );
 void s_test_bool_expr( struct semantic* semantic, struct expr* expr );
+void s_forget_non_null_refs( struct semantic* semantic );
+void s_save_non_null_refs( struct semantic* semantic, struct list* saved );
+void s_restore_non_null_refs( struct semantic* semantic, struct list* saved );
+void s_restore_surviving_non_null_refs( struct semantic* semantic,
+   struct list* saved );
+void s_assume_cond( struct semantic* semantic, struct expr* expr,
+   bool value );
+void s_assume_non_null_var( struct semantic* semantic, struct var* var );
 void s_init_stmt_test( struct stmt_test*, struct stmt_test* );
 void s_test_top_block( struct semantic* semantic, struct block* block );
 void s_test_func_block( struct semantic* semantic, struct func* func,
@@ -206,6 +245,9 @@ void s_bind_name( struct semantic* semantic, struct name* name,
    struct object* object );
 void s_bind_local_name( struct semantic* semantic, struct name* name,
    struct object* object, bool block_scope );
+void s_record_use( struct semantic* semantic, struct object* object );
+void s_record_call_use( struct semantic* semantic, struct call* call );
+void s_eval_const_calls( struct semantic* semantic );
 void s_diag( struct semantic* semantic, int flags, ... );
 void s_bail( struct semantic* semantic );
 void p_test_inline_asm( struct semantic* semantic, struct stmt_test* test,
@@ -234,7 +276,7 @@ bool s_is_primitive_type( struct type_info* type );
 void s_iterate_type( struct semantic* semantic, struct type_info* type,
    struct type_iter* iter );
 void s_init_object_search( struct object_search* search, int requested_node,
-   struct pos* pos, const char* name );
+   struct pos* pos, struct atom* name );
 void s_search_object( struct semantic* semantic,
    struct object_search* search );
 void s_init_follower( struct follower* follower, struct path* path,
@@ -246,10 +288,11 @@ void s_unknown_ns_object( struct semantic* semantic, struct ns* ns,
    const char* object_name, struct pos* pos );
 bool s_is_scalar( struct type_info* type );
 bool s_is_str_value_type( struct type_info* type );
-void s_take_type_snapshot( struct type_info* type,
+void s_take_type_snapshot( struct semantic* semantic, struct type_info* type,
    struct type_snapshot* snapshot );
 void s_take_fine_type_snapshot( struct type_info* type,
    struct type_snapshot* snapshot, bool force_dup_ref );
+struct ref* s_intern_ref( struct semantic* semantic, struct ref* ref );
 bool s_is_onedim_int_array( struct type_info* type );
 bool s_is_int_value( struct type_info* type );
 bool s_is_str_value( struct type_info* type );
@@ -262,14 +305,14 @@ void s_type_mismatch( struct semantic* semantic, const char* label_a,
    struct pos* pos );
 void s_test_nested_func( struct semantic* semantic, struct func* func );
 int s_spec( struct semantic* semantic, int spec );
-struct object* s_get_ns_object( struct ns* ns, const char* object_name,
-   int requested_node );
-struct object* s_get_direct_ns_object( struct ns* ns, const char* object_name,
+struct object* s_get_ns_object( struct ns* ns, struct atom* object_name,
    int requested_node );
+struct object* s_get_direct_ns_object( struct ns* ns,
+   struct atom* object_name, int requested_node );
 struct object* s_get_local_object( struct semantic* semantic,
-   const char* object_name, int requested_node );
+   struct atom* object_name, int requested_node );
 struct object* s_get_object( struct semantic* semantic,
-   const char* object_name, int requested_node );
+   struct atom* object_name, int requested_node );
 bool s_is_enumerator( struct type_info* type );
 bool s_is_null( struct type_info* type );
 bool s_is_nullable( struct type_info* type );
@@ -21,6 +21,7 @@ static void bind_builtin_aliases( struct semantic* semantic,
    struct builtin_aliases* aliases );
 static void test_block_item( struct semantic* semantic, struct stmt_test* test,
    struct node* node );
+static void test_nested_func( struct semantic* semantic, struct func* func );
 static void test_case( struct semantic* semantic, struct stmt_test* test,
    struct case_label* label );
 static void test_default_case( struct semantic* semantic,
@@ -37,6 +38,14 @@ static void test_heavy_cond( struct semantic* semantic, struct stmt_test* test,
 static struct pos* get_heavy_cond_pos( struct heavy_cond* cond );
 static void test_switch( struct semantic* semantic, struct stmt_test* test,
    struct switch_stmt* stmt );
+static void sort_cases( struct semantic* semantic, struct stmt_test* test,
+   struct switch_stmt* stmt );
+static int compare_cases( void* context, void* a, void* b );
+static void check_dup_case( struct semantic* semantic,
+   struct stmt_test* test, struct case_label* label );
+static void grow_case_table( struct stmt_test* test );
+static unsigned int hash_case_value( int value );
+static struct case_label* find_case( struct switch_stmt* stmt, int value );
 static void test_switch_cond( struct semantic* semantic,
    struct stmt_test* test, struct switch_stmt* stmt );
 static void warn_switch_skipped_init( struct semantic* semantic,
@@ -95,7 +104,10 @@ void s_init_stmt_test( struct stmt_test* test, struct stmt_test* parent ) {
    test->buildmsg = NULL;
    test->jump_break = NULL;
    test->jump_continue = NULL;
+   list_init( &test->cases );
    test->num_cases = 0;
+   test->case_buckets = NULL;
+   test->case_capacity = 0;
    test->flow = FLOW_GOING;
    test->in_loop = false;
    test->manual_scope = false;
@@ -212,7 +224,7 @@ static void test_block_item( struct semantic* semantic, struct stmt_test* test,
          ( struct structure* ) node );
       break;
    case NODE_FUNC:
-      s_test_nested_func( semantic,
+      test_nested_func( semantic,
          ( struct func* ) node );
       break;
    case NODE_CASE:
@@ -254,8 +266,18 @@ static void test_block_item( struct semantic* semantic, struct stmt_test* test,
    }
 }
 
+// The declaration of a nested function is not executed, so what is known about
+// the references of the enclosing function does not change.
+static void test_nested_func( struct semantic* semantic, struct func* func ) {
+   struct list saved_refs;
+   s_save_non_null_refs( semantic, &saved_refs );
+   s_test_nested_func( semantic, func );
+   s_restore_non_null_refs( semantic, &saved_refs );
+}
+
 static void test_case( struct semantic* semantic, struct stmt_test* test,
    struct case_label* label ) {
+   s_forget_non_null_refs( semantic );
    struct stmt_test* switch_test = test->parent;
    while ( switch_test && ! switch_test->switch_stmt ) {
       switch_test = switch_test->parent;
@@ -296,29 +318,8 @@ static void test_case( struct semantic* semantic, struct stmt_test* test,
          "case value not a valid string" );
       s_bail( semantic );
    }
-   // Check for a duplicate case.
-   struct case_label* prev = NULL;
-   struct case_label* curr = switch_test->switch_stmt->case_head;
-   while ( curr && curr->number->value < label->number->value ) {
-      prev = curr;
-      curr = curr->next;
-   }
-   if ( curr && curr->number->value == label->number->value ) {
-      s_diag( semantic, DIAG_POS_ERR, &label->pos,
-         "duplicate case" );
-      s_diag( semantic, DIAG_POS, &curr->pos,
-         "case with same value previously found here" );
-      s_bail( semantic );
-   }
-   // Append case.
-   if ( prev ) {
-      label->next = prev->next;
-      prev->next = label;
-   }
-   else {
-      label->next = switch_test->switch_stmt->case_head;
-      switch_test->switch_stmt->case_head = label;
-   }
+   check_dup_case( semantic, switch_test, label );
+   list_append( &switch_test->cases, label );
    ++switch_test->num_cases;
    // Flow.
    if ( switch_test->switch_stmt->cond.expr &&
@@ -336,6 +337,7 @@ static void test_case( struct semantic* semantic, struct stmt_test* test,
 
 static void test_default_case( struct semantic* semantic,
    struct stmt_test* test, struct case_label* label ) {
+   s_forget_non_null_refs( semantic );
    struct stmt_test* switch_test = test->parent;
    while ( switch_test && ! switch_test->switch_stmt ) {
       switch_test = switch_test->parent;
@@ -373,6 +375,8 @@ static void test_default_case( struct semantic* semantic,
 
 static void test_assert( struct semantic* semantic, struct stmt_test* test,
    struct assert* assert ) {
+   struct list saved_refs;
+   s_save_non_null_refs( semantic, &saved_refs );
    s_test_bool_expr( semantic, assert->cond );
    if ( assert->is_static ) {
       if ( ! assert->cond->folded ) {
@@ -400,6 +404,8 @@ static void test_assert( struct semantic* semantic, struct stmt_test* test,
          }
       }
    }
+   // Assertions can be left out of the compiled code.
+   s_restore_surviving_non_null_refs( semantic, &saved_refs );
    // Execute static-assert.
    if ( assert->is_static ) {
       if ( ! assert->cond->value ) {
@@ -494,6 +500,7 @@ static void test_stmt( struct semantic* semantic, struct stmt_test* test,
    case NODE_INLINE_ASM:
       p_test_inline_asm( semantic, test,
          ( struct inline_asm* ) node );
+      s_forget_non_null_refs( semantic );
       break;
    default:
       S_UNREACHABLE( semantic );
@@ -504,14 +511,27 @@ static void test_if( struct semantic* semantic, struct stmt_test* test,
    struct if_stmt* stmt ) {
    s_add_scope( semantic, false );
    test_heavy_cond( semantic, test, &stmt->cond );
+   struct list saved_refs;
+   s_save_non_null_refs( semantic, &saved_refs );
+   if ( stmt->cond.expr ) {
+      s_assume_cond( semantic, stmt->cond.expr, true );
+   }
+   else {
+      s_assume_non_null_var( semantic, stmt->cond.var );
+   }
    struct stmt_test body;
    s_init_stmt_test( &body, test );
    test_stmt( semantic, &body, stmt->body );
+   s_restore_non_null_refs( semantic, &saved_refs );
+   if ( stmt->cond.expr ) {
+      s_assume_cond( semantic, stmt->cond.expr, false );
+   }
    struct stmt_test else_body;
    s_init_stmt_test( &else_body, test );
    if ( stmt->else_body ) {
       test_stmt( semantic, &else_body, stmt->else_body );
    }
+   s_forget_non_null_refs( semantic );
    // Flow.
    // Constant condition:
    if ( stmt->cond.expr && stmt->cond.expr->folded ) {
@@ -603,8 +623,10 @@ static void test_switch( struct semantic* semantic, struct stmt_test* test,
    s_init_stmt_test( &body, test );
    body.case_allowed = true;
    test_stmt( semantic, &body, stmt->body );
+   s_forget_non_null_refs( semantic );
    stmt->jump_break = test->jump_break;
-   if ( stmt->case_head || stmt->case_default ) {
+   sort_cases( semantic, test, stmt );
+   if ( stmt->num_cases > 0 || stmt->case_default ) {
       warn_switch_skipped_init( semantic, ( struct block* ) stmt->body );
    }
    // For a condition of an enumeration type, make sure each enumerator is
@@ -617,11 +639,7 @@ static void test_switch( struct semantic* semantic, struct stmt_test* test,
       int missing = 0;
       struct enumerator* enumerator = test->cond_type.enumeration->head;
       while ( enumerator ) {
-         struct case_label* label = stmt->case_head;
-         while ( label && label->number->value != enumerator->value ) {
-            label = label->next;
-         }
-         if ( ! label ) {
+         if ( ! find_case( stmt, enumerator->value ) ) {
             // Report an error on the first missing case.
             if ( missing == 0 ) {
                s_diag( semantic, DIAG_POS_ERR,
@@ -661,6 +679,111 @@ static void test_switch( struct semantic* semantic, struct stmt_test* test,
    s_pop_scope( semantic );
 }
 
+// Sorts the cases by their value. Duplicate cases have already been reported,
+// so every value is unique.
+static void sort_cases( struct semantic* semantic, struct stmt_test* test,
+   struct switch_stmt* stmt ) {
+   stmt->num_cases = list_size( &test->cases );
+   if ( stmt->num_cases == 0 ) {
+      return;
+   }
+   stmt->cases = mem_alloc( sizeof( *stmt->cases ) * stmt->num_cases );
+   struct list_iter i;
+   list_iterate( &test->cases, &i );
+   int count = 0;
+   while ( ! list_end( &i ) ) {
+      stmt->cases[ count ] = list_data( &i );
+      ++count;
+      list_next( &i );
+   }
+   void** temp = mem_alloc( sizeof( *temp ) * stmt->num_cases );
+   sort_ptrs( ( void** ) stmt->cases, temp, stmt->num_cases, compare_cases,
+      NULL );
+   mem_free( temp );
+   list_deinit( &test->cases );
+   mem_free( test->case_buckets );
+}
+
+static int compare_cases( void* context, void* a, void* b ) {
+   int left = ( ( struct case_label* ) a )->number->value;
+   int right = ( ( struct case_label* ) b )->number->value;
+   return ( left < right ) ? -1 : ( left > right );
+}
+
+// Reports the case if its value is used by a previous case. Otherwise, adds
+// the case to the table of cases.
+static void check_dup_case( struct semantic* semantic,
+   struct stmt_test* test, struct case_label* label ) {
+   if ( ( test->num_cases + 1 ) * 2 > test->case_capacity ) {
+      grow_case_table( test );
+   }
+   unsigned int mask = test->case_capacity - 1;
+   unsigned int i = hash_case_value( label->number->value ) & mask;
+   while ( test->case_buckets[ i ] ) {
+      struct case_label* prev = test->case_buckets[ i ];
+      if ( prev->number->value == label->number->value ) {
+         s_diag( semantic, DIAG_POS_ERR, &label->pos,
+            "duplicate case" );
+         s_diag( semantic, DIAG_POS, &prev->pos,
+            "case with same value previously found here" );
+         s_bail( semantic );
+      }
+      i = ( i + 1 ) & mask;
+   }
+   test->case_buckets[ i ] = label;
+}
+
+static void grow_case_table( struct stmt_test* test ) {
+   enum { INITIAL_CAPACITY = 16 };
+   int capacity = test->case_capacity ? test->case_capacity * 2 :
+      INITIAL_CAPACITY;
+   struct case_label** buckets = mem_alloc( sizeof( *buckets ) * capacity );
+   memset( buckets, 0, sizeof( *buckets ) * capacity );
+   unsigned int mask = capacity - 1;
+   for ( int k = 0; k < test->case_capacity; ++k ) {
+      struct case_label* label = test->case_buckets[ k ];
+      if ( label ) {
+         unsigned int i = hash_case_value( label->number->value ) & mask;
+         while ( buckets[ i ] ) {
+            i = ( i + 1 ) & mask;
+         }
+         buckets[ i ] = label;
+      }
+   }
+   if ( test->case_buckets ) {
+      mem_free( test->case_buckets );
+   }
+   test->case_buckets = buckets;
+   test->case_capacity = capacity;
+}
+
+// Case values are often multiples of a power of two, so the bits are mixed
+// before the low bits pick a bucket.
+inline static unsigned int hash_case_value( int value ) {
+   unsigned int hash = ( unsigned int ) value * 2654435761u;
+   return hash ^ ( hash >> 16 );
+}
+
+// Finds the first case with the specified value.
+static struct case_label* find_case( struct switch_stmt* stmt, int value ) {
+   int left = 0;
+   int right = stmt->num_cases;
+   while ( left < right ) {
+      int middle = left + ( right - left ) / 2;
+      if ( stmt->cases[ middle ]->number->value < value ) {
+         left = middle + 1;
+      }
+      else {
+         right = middle;
+      }
+   }
+   if ( left < stmt->num_cases &&
+      stmt->cases[ left ]->number->value == value ) {
+      return stmt->cases[ left ];
+   }
+   return NULL;
+}
+
 static void test_switch_cond( struct semantic* semantic,
    struct stmt_test* test, struct switch_stmt* stmt ) {
    test_heavy_cond( semantic, test, &stmt->cond );
@@ -707,10 +830,15 @@ static void test_while( struct semantic* semantic, struct stmt_test* test,
    struct while_stmt* stmt ) {
    s_add_scope( semantic, false );
    test->in_loop = true;
+   s_forget_non_null_refs( semantic );
    test_cond( semantic, &stmt->cond );
+   if ( stmt->cond.u.node->type == NODE_EXPR ) {
+      s_assume_cond( semantic, stmt->cond.u.expr, ( ! stmt->until ) );
+   }
    struct stmt_test body;
    s_init_stmt_test( &body, test );
    test_block( semantic, &body, NULL, stmt->body );
+   s_forget_non_null_refs( semantic );
    stmt->jump_break = test->jump_break;
    stmt->jump_continue = test->jump_continue;
    // Flow.
@@ -729,12 +857,15 @@ static void test_do( struct semantic* semantic, struct stmt_test* test,
    struct do_stmt* stmt ) {
    s_add_scope( semantic, false );
    test->in_loop = true;
+   s_forget_non_null_refs( semantic );
    struct stmt_test body;
    s_init_stmt_test( &body, test );
    test_block( semantic, &body, NULL, stmt->body );
    stmt->jump_break = test->jump_break;
    stmt->jump_continue = test->jump_continue;
+   s_forget_non_null_refs( semantic );
    s_test_bool_expr( semantic, stmt->cond );
+   s_forget_non_null_refs( semantic );
    // Flow.
    if ( stmt->cond->folded ) {
       if ( ( ! stmt->until && stmt->cond->value != 0 ) ||
@@ -789,10 +920,12 @@ static void test_for( struct semantic* semantic, struct stmt_test* test,
       list_next( &i );
    }
    // Condition.
+   s_forget_non_null_refs( semantic );
    if ( stmt->cond.u.node ) {
       test_cond( semantic, &stmt->cond );
    }
    // Post expressions.
+   s_forget_non_null_refs( semantic );
    list_iterate( &stmt->post, &i );
    while ( ! list_end( &i ) ) {
       struct expr_test expr;
@@ -800,9 +933,11 @@ static void test_for( struct semantic* semantic, struct stmt_test* test,
       s_test_expr( semantic, &expr, list_data( &i ) );
       list_next( &i );
    }
+   s_forget_non_null_refs( semantic );
    struct stmt_test body;
    s_init_stmt_test( &body, test );
    test_stmt( semantic, &body, stmt->body );
+   s_forget_non_null_refs( semantic );
    stmt->jump_break = test->jump_break;
    stmt->jump_continue = test->jump_continue;
    // Flow.
@@ -870,9 +1005,11 @@ static void test_foreach( struct semantic* semantic, struct stmt_test* test,
       s_bail( semantic );
    }
    // Body.
+   s_forget_non_null_refs( semantic );
    struct stmt_test body;
    s_init_stmt_test( &body, test );
    test_stmt( semantic, &body, stmt->body );
+   s_forget_non_null_refs( semantic );
    stmt->jump_break = test->jump_break;
    stmt->jump_continue = test->jump_continue;
    s_pop_scope( semantic );
@@ -1024,7 +1161,7 @@ static void test_return_value( struct semantic* semantic,
       }
       else {
          struct type_snapshot snapshot;
-         s_take_type_snapshot( &expr.type, &snapshot );
+         s_take_type_snapshot( semantic, &expr.type, &snapshot );
          func->ref = snapshot.ref;
          func->enumeration = snapshot.enumeration;
          func->structure = snapshot.structure;
@@ -1073,7 +1210,7 @@ static void test_goto( struct semantic* semantic, struct stmt_test* test,
    list_iterate( semantic->func_test->labels, &i );
    while ( ! list_end( &i ) ) {
       struct label* label = list_data( &i );
-      if ( strcmp( label->name, stmt->label_name ) == 0 ) {
+      if ( label->atom == stmt->label_atom ) {
          stmt->label = label;
          list_append( &label->users, stmt ); 
          break;
@@ -1090,6 +1227,7 @@ static void test_goto( struct semantic* semantic, struct stmt_test* test,
 static void test_label( struct semantic* semantic, struct stmt_test* test,
    struct label* label ) {
    label->buildmsg = semantic->func_test->enclosing_buildmsg;
+   s_forget_non_null_refs( semantic );
 }
 
 static void test_paltrans( struct semantic* semantic, struct stmt_test* test,
@@ -1166,6 +1304,7 @@ static void test_palrange_tint( struct semantic* semantic,
 static void test_buildmsg_stmt( struct semantic* semantic,
    struct stmt_test* test, struct buildmsg_stmt* stmt ) {
    test->buildmsg = stmt->buildmsg;
+   s_forget_non_null_refs( semantic );
    struct expr_test expr_test;
    s_init_expr_test( &expr_test, false, false );
    expr_test.buildmsg = stmt->buildmsg;
@@ -1182,7 +1321,9 @@ static void test_buildmsg_block( struct semantic* semantic,
    block_test.buildmsg = buildmsg;
    struct builtin_aliases aliases;
    init_builtin_aliases( semantic, &aliases, BUILTINALIASESUSER_BUILDMSG );
+   s_forget_non_null_refs( semantic );
    test_block( semantic, &block_test, &aliases, buildmsg->block );
+   s_forget_non_null_refs( semantic );
    if ( ! list_size( &buildmsg->usages ) ) {
       s_diag( semantic, DIAG_POS_ERR, &buildmsg->block->pos,
          "unused message-building block" );
@@ -1247,7 +1388,7 @@ static void check_dup_label( struct semantic* semantic ) {
       struct list_iter k = i;
       while ( ! list_end( &k ) ) {
          struct label* other_label = list_data( &k );
-         if ( strcmp( label->name, other_label->name ) == 0 ) {
+         if ( label->atom == other_label->atom ) {
             s_diag( semantic, DIAG_POS_ERR, &label->pos,
                "duplicate label `%s`", label->name );
             s_diag( semantic, DIAG_POS, &other_label->pos,
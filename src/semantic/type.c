@@ -1,7 +1,14 @@
 #include <string.h>
+#include <stdint.h>
 
 #include "phase.h"
 
+struct canonical_ref {
+   struct canonical_ref* next;
+   struct ref* ref;
+   unsigned int hash;
+};
+
 static void create_implicit_ref( struct type_info* type );
 static bool same_ref( struct ref* a, struct ref* b );
 static bool same_ref_struct( struct ref_struct* a, struct ref_struct* b );
@@ -17,6 +24,9 @@ static void present_ref( struct ref* ref, struct str* string );
 static void present_dim( struct type_info* type, struct str* string );
 static void present_param_list( struct param* param, struct str* string );
 static struct ref* dup_ref( struct ref* ref );
+static unsigned int hash_ref( struct ref* ref, struct ref* next );
+static bool same_ref_fields( struct ref* a, struct ref* b );
+static void grow_ref_table( struct semantic* semantic );
 static void set_storage( struct type_info* type, int storage );
 
 void s_init_type_info( struct type_info* type, struct ref* ref,
@@ -188,6 +198,10 @@ bool s_same_type( struct type_info* a, struct type_info* b ) {
 
 static bool same_ref( struct ref* a, struct ref* b ) {
    while ( a && b ) {
+      // Canonical references are shared, so the rest of the chain is the same.
+      if ( a == b ) {
+         return true;
+      }
       if ( ! ( a->type == b->type ) ) {
          return false;
       }
@@ -230,6 +244,9 @@ static bool same_ref_array( struct ref_array* a, struct ref_array* b ) {
 static bool same_ref_func( struct ref_func* a, struct ref_func* b ) {
    struct param* param_a = a->params;
    struct param* param_b = b->params;
+   if ( param_a == param_b ) {
+      return ( a->local == b->local );
+   }
    while ( param_a && param_b &&
       param_a->spec == param_b->spec &&
       same_ref( param_a->ref, param_b->ref ) ) {
@@ -268,11 +285,11 @@ static bool compatible_raw_spec( int spec ) {
 }
 
 static bool same_dim( struct dim* a, struct dim* b ) {
-   while ( a && b && a->length == b->length ) {
+   while ( a && b && a != b && a->length == b->length ) {
       a = a->next;
       b = b->next;
    }
-   return ( a == NULL && b == NULL );
+   return ( a == b );
 }
 
 bool s_common_type( struct type_info* a, struct type_info* b,
@@ -589,9 +606,14 @@ enum subscript_result s_subscript_array_ref( struct semantic* semantic,
 // data unless it is necessary. Be careful when editing the data returned by
 // this function because multiple objects might be sharing the same instance.
 // Maybe avoid this whole situation and just allocate new instances every time? 
-void s_take_type_snapshot( struct type_info* type,
+void s_take_type_snapshot( struct semantic* semantic, struct type_info* type,
    struct type_snapshot* snapshot ) {
-   s_take_fine_type_snapshot( type, snapshot, false );
+   snapshot->ref = s_intern_ref( semantic, type->ref );
+   snapshot->structure = type->structure;
+   snapshot->enumeration = type->enumeration;
+   snapshot->dim = type->dim;
+   snapshot->spec = type->spec;
+   snapshot->storage = type->storage;
 }
 
 void s_take_fine_type_snapshot( struct type_info* type,
@@ -624,6 +646,127 @@ static struct ref* dup_ref( struct ref* ref ) {
    return dup;
 }
 
+// Returns the canonical copy of the reference chain. The canonical copy must
+// not be modified.
+struct ref* s_intern_ref( struct semantic* semantic, struct ref* ref ) {
+   if ( ! ref ) {
+      return NULL;
+   }
+   struct ref* next = s_intern_ref( semantic, ref->next );
+   unsigned int hash = hash_ref( ref, next );
+   if ( semantic->ref_buckets ) {
+      struct canonical_ref* entry = semantic->ref_buckets[ hash &
+         ( semantic->ref_capacity - 1 ) ];
+      while ( entry ) {
+         if ( entry->hash == hash && entry->ref->next == next &&
+            same_ref_fields( entry->ref, ref ) ) {
+            return entry->ref;
+         }
+         entry = entry->next;
+      }
+   }
+   if ( semantic->ref_size == semantic->ref_capacity ) {
+      grow_ref_table( semantic );
+   }
+   struct canonical_ref* entry = mem_alloc( sizeof( *entry ) );
+   entry->ref = dup_ref( ref );
+   entry->ref->next = next;
+   entry->hash = hash;
+   struct canonical_ref** bucket = &semantic->ref_buckets[ hash &
+      ( semantic->ref_capacity - 1 ) ];
+   entry->next = *bucket;
+   *bucket = entry;
+   ++semantic->ref_size;
+   return entry->ref;
+}
+
+static unsigned int hash_ref( struct ref* ref, struct ref* next ) {
+   unsigned int hash = ( unsigned int ) ( ( uintptr_t ) next >> 3 );
+   hash = hash * 31 + ref->type;
+   hash = hash * 31 + ref->nullable;
+   switch ( ref->type ) {
+   case REF_STRUCTURE: {
+         struct ref_struct* structure = ( struct ref_struct* ) ref;
+         hash = hash * 31 + structure->storage;
+      }
+      break;
+   case REF_ARRAY: {
+         struct ref_array* array = ( struct ref_array* ) ref;
+         hash = hash * 31 + array->dim_count;
+         hash = hash * 31 + array->storage;
+      }
+      break;
+   case REF_FUNCTION: {
+         struct ref_func* func = ( struct ref_func* ) ref;
+         hash = hash * 31 +
+            ( unsigned int ) ( ( uintptr_t ) func->params >> 3 );
+      }
+      break;
+   default:
+      break;
+   }
+   return hash * 2654435761u;
+}
+
+// Compares every field of the references, except the position and the next
+// reference.
+static bool same_ref_fields( struct ref* a, struct ref* b ) {
+   if ( ! ( a->type == b->type && a->nullable == b->nullable ) ) {
+      return false;
+   }
+   switch ( a->type ) {
+   case REF_STRUCTURE: {
+         struct ref_struct* structure_a = ( struct ref_struct* ) a;
+         struct ref_struct* structure_b = ( struct ref_struct* ) b;
+         return ( structure_a->storage == structure_b->storage &&
+            structure_a->storage_index == structure_b->storage_index );
+      }
+   case REF_ARRAY: {
+         struct ref_array* array_a = ( struct ref_array* ) a;
+         struct ref_array* array_b = ( struct ref_array* ) b;
+         return ( array_a->dim_count == array_b->dim_count &&
+            array_a->storage == array_b->storage &&
+            array_a->storage_index == array_b->storage_index );
+      }
+   case REF_FUNCTION: {
+         struct ref_func* func_a = ( struct ref_func* ) a;
+         struct ref_func* func_b = ( struct ref_func* ) b;
+         return ( func_a->params == func_b->params &&
+            func_a->min_param == func_b->min_param &&
+            func_a->max_param == func_b->max_param &&
+            func_a->local == func_b->local );
+      }
+   default:
+      return true;
+   }
+}
+
+static void grow_ref_table( struct semantic* semantic ) {
+   enum { INITIAL_CAPACITY = 64 };
+   int capacity = ( semantic->ref_capacity > 0 ) ?
+      semantic->ref_capacity * 2 : INITIAL_CAPACITY;
+   struct canonical_ref** buckets = mem_alloc( sizeof( *buckets ) * capacity );
+   for ( int i = 0; i < capacity; ++i ) {
+      buckets[ i ] = NULL;
+   }
+   for ( int i = 0; i < semantic->ref_capacity; ++i ) {
+      struct canonical_ref* entry = semantic->ref_buckets[ i ];
+      while ( entry ) {
+         struct canonical_ref* next = entry->next;
+         struct canonical_ref** bucket = &buckets[ entry->hash &
+            ( capacity - 1 ) ];
+         entry->next = *bucket;
+         *bucket = entry;
+         entry = next;
+      }
+   }
+   if ( semantic->ref_buckets ) {
+      mem_free( semantic->ref_buckets );
+   }
+   semantic->ref_buckets = buckets;
+   semantic->ref_capacity = capacity;
+}
+
 bool s_is_onedim_int_array( struct type_info* type ) {
    return ( type->dim && ! type->dim->next && ! type->structure &&
       ! type->ref && ( type->spec == SPEC_INT || type->spec == SPEC_RAW ) );
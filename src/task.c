@@ -1,6 +1,7 @@
 #include <string.h>
 #include <stdarg.h>
 #include <time.h>
+#include <ctype.h>
 
 #include "task.h"
 
@@ -50,6 +51,19 @@ static void init_ref( struct ref* ref, int type );
 static bool is_object_in_ns( struct ns* ns, struct object* object );
 static bool is_object_in_fragment( struct ns_fragment* fragment,
    struct object* object );
+static void grow_str_table( struct str_table* table );
+static void grow_name_children( struct name* parent );
+static void resize_name_children( struct name* parent, int capacity );
+static void grow_atom_table( void );
+static bool is_name_separator( struct name* name );
+static struct name* cache_full_name( struct name* name );
+
+// Atoms are shared by every task, so the table is global.
+static struct {
+   struct atom** buckets;
+   int capacity;
+   int size;
+} g_atoms = { NULL, 0, 0 };
 
 void t_init( struct task* task, struct options* options, jmp_buf* bail,
    struct str* compiler_dir ) {
@@ -168,6 +182,9 @@ struct ns_fragment* t_alloc_ns_fragment( void ) {
    fragment->path = NULL;
    fragment->unresolved = NULL;
    fragment->unresolved_tail = NULL;
+   fragment->ready = NULL;
+   fragment->ready_tail = NULL;
+   fragment->waiting = 0;
    list_init( &fragment->objects );
    list_init( &fragment->funcs );
    list_init( &fragment->scripts );
@@ -188,12 +205,28 @@ void t_append_unresolved_namespace_object( struct ns_fragment* fragment,
       fragment->unresolved = object;
    }
    fragment->unresolved_tail = object;
+   t_queue_unresolved_namespace_object( fragment, object );
+}
+
+void t_queue_unresolved_namespace_object( struct ns_fragment* fragment,
+   struct object* object ) {
+   object->fragment = fragment;
+   object->next_ready = NULL;
+   if ( fragment->ready ) {
+      fragment->ready_tail->next_ready = object;
+   }
+   else {
+      fragment->ready = object;
+   }
+   fragment->ready_tail = object;
 }
 
 static void init_str_table( struct str_table* table ) {
    table->head = NULL;
    table->tail = NULL;
-   table->root = NULL;
+   table->buckets = NULL;
+   table->strings = NULL;
+   table->capacity = 0;
    table->size = 0;
 }
 
@@ -201,61 +234,214 @@ struct name* t_create_name( void ) {
    struct name* name = mem_slot_alloc( sizeof( *name ) );
    name->parent = NULL;
    name->next = NULL;
-   name->drop = NULL;
+   name->children = NULL;
    name->object = NULL;
-   name->ch = 0;
+   name->atom = NULL;
+   name->full_name = NULL;
+   name->full_name_length = 0;
+   name->full_name_separators = 0;
+   name->num_children = 0;
+   name->children_capacity = 0;
    return name;
 }
 
+// Each component of the extension, either a dot or a run of non-dot
+// characters, becomes a separate name.
 struct name* t_extend_name( struct name* parent, const char* extension ) {
-   struct name* name = parent->drop;
    const char* ch = extension;
    while ( *ch ) {
-      // Find the correct node to enter.
-      struct name* prev = NULL;
-      while ( name && name->ch < *ch ) {
-         prev = name;
-         name = name->next;
+      const char* start = ch;
+      if ( *ch == '.' ) {
+         ++ch;
       }
-      // Enter a new node if no node could be found.
-      if ( ! name ) {
-         name = t_create_name();
-         name->parent = parent;
-         name->ch = *ch;
-         if ( prev ) {
-            prev->next = name;
+      else {
+         while ( *ch && *ch != '.' ) {
+            ++ch;
          }
-         else {
-            parent->drop = name;
+      }
+      parent = t_extend_name_atom( parent,
+         t_intern_atom( start, ch - start ) );
+   }
+   return parent;
+}
+
+struct name* t_extend_name_atom( struct name* parent, struct atom* atom ) {
+   struct name* name = t_find_name_atom( parent, atom );
+   if ( name ) {
+      return name;
+   }
+   if ( parent->num_children == parent->children_capacity ) {
+      grow_name_children( parent );
+   }
+   name = t_create_name();
+   name->parent = parent;
+   name->atom = atom;
+   struct name** bucket = &parent->children[ atom->hash &
+      ( parent->children_capacity - 1 ) ];
+   name->next = *bucket;
+   *bucket = name;
+   ++parent->num_children;
+   return name;
+}
+
+// Unlike t_extend_name_atom(), a missing name is not created.
+struct name* t_find_name_atom( struct name* parent, struct atom* atom ) {
+   if ( parent->children ) {
+      struct name* name = parent->children[ atom->hash &
+         ( parent->children_capacity - 1 ) ];
+      while ( name ) {
+         if ( name->atom == atom ) {
+            return name;
          }
+         name = name->next;
+      }
+   }
+   return NULL;
+}
+
+// Makes room for the specified number of child names, so adding that many
+// names does not grow the table again.
+void t_reserve_name_children( struct name* parent, int count ) {
+   int capacity = ( parent->children_capacity > 0 ) ?
+      parent->children_capacity : 4;
+   while ( capacity < count ) {
+      capacity *= 2;
+   }
+   if ( capacity > parent->children_capacity ) {
+      resize_name_children( parent, capacity );
+   }
+}
+
+static void grow_name_children( struct name* parent ) {
+   enum { INITIAL_CAPACITY = 4 };
+   resize_name_children( parent, ( parent->children_capacity > 0 ) ?
+      parent->children_capacity * 2 : INITIAL_CAPACITY );
+}
+
+static void resize_name_children( struct name* parent, int capacity ) {
+   struct name** children = mem_alloc( sizeof( *children ) * capacity );
+   for ( int i = 0; i < capacity; ++i ) {
+      children[ i ] = NULL;
+   }
+   for ( int i = 0; i < parent->children_capacity; ++i ) {
+      struct name* name = parent->children[ i ];
+      while ( name ) {
+         struct name* next = name->next;
+         struct name** bucket = &children[ name->atom->hash &
+            ( capacity - 1 ) ];
+         name->next = *bucket;
+         *bucket = name;
+         name = next;
       }
-      // Enter a new node if no node with the same character exists in the
-      // parent node.
-      else if ( name->ch != *ch ) {
-         struct name* smaller_name = t_create_name();
-         smaller_name->next = name;
-         smaller_name->parent = parent;
-         smaller_name->ch = *ch;
-         name = smaller_name;
-         if ( prev ) {
-            prev->next = name;
+   }
+   if ( parent->children ) {
+      mem_free( parent->children );
+   }
+   parent->children = children;
+   parent->children_capacity = capacity;
+}
+
+struct atom* t_intern_atom( const char* text, int length ) {
+   unsigned int hash = t_hash_text( text, length, false );
+   if ( g_atoms.buckets ) {
+      struct atom* atom = g_atoms.buckets[ hash & ( g_atoms.capacity - 1 ) ];
+      while ( atom ) {
+         if ( atom->hash == hash && atom->length == length &&
+            memcmp( atom->text, text, length ) == 0 ) {
+            return atom;
          }
-         else {
-            parent->drop = name;
+         atom = atom->next;
+      }
+   }
+   if ( g_atoms.size == g_atoms.capacity ) {
+      grow_atom_table();
+   }
+   struct atom* atom = mem_alloc( sizeof( *atom ) + length + 1 );
+   char* atom_text = ( char* ) ( atom + 1 );
+   memcpy( atom_text, text, length );
+   atom_text[ length ] = '\0';
+   atom->lowercase = NULL;
+   atom->text = atom_text;
+   atom->length = length;
+   atom->id = g_atoms.size;
+   atom->hash = hash;
+   struct atom** bucket = &g_atoms.buckets[ hash & ( g_atoms.capacity - 1 ) ];
+   atom->next = *bucket;
+   *bucket = atom;
+   ++g_atoms.size;
+   return atom;
+}
+
+struct atom* t_lowercase_atom( struct atom* atom ) {
+   if ( ! atom->lowercase ) {
+      int i = 0;
+      while ( i < atom->length && ! isupper( atom->text[ i ] ) ) {
+         ++i;
+      }
+      if ( i < atom->length ) {
+         struct str text;
+         str_init( &text );
+         str_append( &text, atom->text );
+         for ( ; i < text.length; ++i ) {
+            text.value[ i ] = tolower( text.value[ i ] );
          }
+         atom->lowercase = t_intern_atom( text.value, text.length );
+         atom->lowercase->lowercase = atom->lowercase;
+         str_deinit( &text );
+      }
+      else {
+         atom->lowercase = atom;
       }
-      parent = name;
-      name = name->drop;
-      ++ch;
    }
-   return parent;
+   return atom->lowercase;
+}
+
+static void grow_atom_table( void ) {
+   enum { INITIAL_CAPACITY = 1024 };
+   int capacity = ( g_atoms.capacity > 0 ) ?
+      g_atoms.capacity * 2 : INITIAL_CAPACITY;
+   struct atom** buckets = mem_alloc( sizeof( *buckets ) * capacity );
+   for ( int i = 0; i < capacity; ++i ) {
+      buckets[ i ] = NULL;
+   }
+   for ( int i = 0; i < g_atoms.capacity; ++i ) {
+      struct atom* atom = g_atoms.buckets[ i ];
+      while ( atom ) {
+         struct atom* next = atom->next;
+         struct atom** bucket = &buckets[ atom->hash & ( capacity - 1 ) ];
+         atom->next = *bucket;
+         *bucket = atom;
+         atom = next;
+      }
+   }
+   if ( g_atoms.buckets ) {
+      mem_free( g_atoms.buckets );
+   }
+   g_atoms.buckets = buckets;
+   g_atoms.capacity = capacity;
+}
+
+// FNV-1a. With `fold_case`, the letters of the text are hashed in lowercase.
+unsigned int t_hash_text( const char* text, int length, bool fold_case ) {
+   unsigned int hash = 2166136261u;
+   for ( int i = 0; i < length; ++i ) {
+      unsigned char ch = ( unsigned char ) text[ i ];
+      hash ^= fold_case ? ( unsigned char ) tolower( ch ) : ch;
+      hash *= 16777619u;
+   }
+   return hash;
+}
+
+static bool is_name_separator( struct name* name ) {
+   return ( name->atom && name->atom->length == 1 &&
+      name->atom->text[ 0 ] == '.' );
 }
 
 void t_copy_name( struct name* start, struct str* str ) {
    int length = 0;
    struct name* name = start;
-   while ( name && ! ( name->ch == '\0' || name->ch == '.' ) ) {
-      ++length;
+   while ( name->parent && ! is_name_separator( name ) ) {
+      length += name->atom->length;
       name = name->parent;
    }
    if ( str->buffer_length < length + 1 ) {
@@ -266,61 +452,77 @@ void t_copy_name( struct name* start, struct str* str ) {
    struct name* end = name;
    name = start;
    while ( name != end ) {
-      --length;
-      str->value[ length ] = name->ch;
+      length -= name->atom->length;
+      memcpy( str->value + length, name->atom->text, name->atom->length );
       name = name->parent;
    }
 }
 
 void t_copy_full_name( struct name* start, const char* separator,
    struct str* str ) {
-   int length = 0;
-   struct name* name = start;
+   struct name* name = cache_full_name( start );
    const int separator_length = strlen( separator );
-   while ( name && ! ( name->ch == '\0' || ( name->ch == '.' &&
-      name->parent && name->parent->ch == '\0' ) ) ) {
-      if ( name->ch == '.' ) {
-         length += separator_length;
-      }
-      else {
-         ++length;
-      }
-      name = name->parent;
-   }
+   int length = name->full_name_length +
+      name->full_name_separators * ( separator_length - 1 );
    if ( str->buffer_length < length + 1 ) {
       str_grow( str, length + 1 );
    }
    str->length = length;
-   str->value[ length ] = '\0';
-   struct name* end = name;
-   name = start;
-   while ( name != end ) {
-      if ( name->ch == '.' ) {
-         length -= separator_length;
-         memcpy( str->value + length, separator, separator_length ); 
+   if ( separator_length == 1 && separator[ 0 ] == '.' ) {
+      memcpy( str->value, name->full_name, name->full_name_length + 1 );
+      return;
+   }
+   char* output = str->value;
+   for ( int i = 0; i < name->full_name_length; ++i ) {
+      if ( name->full_name[ i ] == '.' ) {
+         memcpy( output, separator, separator_length );
+         output += separator_length;
       }
       else {
-         --length;
-         str->value[ length ] = name->ch;
+         *output = name->full_name[ i ];
+         ++output;
       }
-      name = name->parent;
    }
+   *output = '\0';
 }
 
 int t_full_name_length( struct name* name, const char* separator ) {
-   int length = 0;
-   const int separator_length = strlen( separator );
-   while ( name && ! ( name->ch == '\0' || ( name->ch == '.' &&
-      name->parent && name->parent->ch == '\0' ) ) ) {
-      if ( name->ch == '.' ) {
-         length += separator_length;
+   cache_full_name( name );
+   return name->full_name_length +
+      name->full_name_separators * ( strlen( separator ) - 1 );
+}
+
+// The fully qualified name excludes the root name and the separator that
+// immediately follows the root name. Identifiers never contain a dot, so
+// the dots in the cached name are exactly the separators.
+static struct name* cache_full_name( struct name* start ) {
+   if ( ! start->full_name ) {
+      int length = 0;
+      int separators = 0;
+      struct name* name = start;
+      while ( name->parent && ! ( is_name_separator( name ) &&
+         ! name->parent->parent ) ) {
+         if ( is_name_separator( name ) ) {
+            ++separators;
+         }
+         length += name->atom->length;
+         name = name->parent;
       }
-      else {
-         ++length;
+      char* full_name = mem_alloc( length + 1 );
+      full_name[ length ] = '\0';
+      struct name* end = name;
+      name = start;
+      int offset = length;
+      while ( name != end ) {
+         offset -= name->atom->length;
+         memcpy( full_name + offset, name->atom->text, name->atom->length );
+         name = name->parent;
       }
-      name = name->parent;
+      start->full_name = full_name;
+      start->full_name_length = length;
+      start->full_name_separators = separators;
    }
-   return length;
+   return start;
 }
 
 void t_init_object( struct object* object, int node_type ) {
@@ -330,6 +532,10 @@ void t_init_object( struct object* object, int node_type ) {
    t_init_pos_id( &object->pos, INTERNALFILE_COMPILER );
    object->next = NULL;
    object->next_scope = NULL;
+   object->dependency = NULL;
+   object->dependents = NULL;
+   object->next_ready = NULL;
+   object->fragment = NULL;
 }
 
 /*
@@ -794,28 +1000,23 @@ struct indexed_string* t_intern_string_copy( struct task* task,
 
 static struct indexed_string* intern_string( struct task* task,
    struct str_table* table, const char* value, int length, bool copy_value ) {
-   // Indexed strings are stored in a binary search tree.
-   struct indexed_string* parent_lchild = NULL;
-   struct indexed_string* parent_rchild = NULL;
-   struct indexed_string* string = table->root;
-   while ( string ) {
-      int result = strcmp( value, string->value );
-      if ( result < 0 ) {
-         parent_lchild = string;
-         parent_rchild = NULL;
-         string = string->left;
-      }
-      else if ( result > 0 ) {
-         parent_lchild = NULL;
-         parent_rchild = string;
-         string = string->right;
-      }
-      else {
-         return string;
+   // Indexed strings are stored in a hash table.
+   unsigned int hash = t_hash_text( value, strlen( value ), false );
+   if ( table->buckets ) {
+      struct indexed_string* string = table->buckets[ hash &
+         ( table->capacity - 1 ) ];
+      while ( string ) {
+         if ( strcmp( value, string->value ) == 0 ) {
+            return string;
+         }
+         string = string->next_bucket;
       }
    }
+   if ( table->size == table->capacity ) {
+      grow_str_table( table );
+   }
    // Allocate a new indexed-string when one isn't interned.
-   string = mem_alloc( sizeof( *string ) );
+   struct indexed_string* string = mem_alloc( sizeof( *string ) );
    if ( copy_value ) {
       string->value = t_intern_text( task, value, length );
    }
@@ -826,8 +1027,6 @@ static struct indexed_string* intern_string( struct task* task,
    string->index = table->size;
    string->index_runtime = -1;
    string->next = NULL;
-   string->left = NULL;
-   string->right = NULL;
    string->used = false;
    string->in_source_code = false;
    if ( table->head ) {
@@ -837,17 +1036,41 @@ static struct indexed_string* intern_string( struct task* task,
       table->head = string;
    }
    table->tail = string;
-   if ( parent_lchild ) {
-      parent_lchild->left = string;
+   struct indexed_string** bucket = &table->buckets[ hash &
+      ( table->capacity - 1 ) ];
+   string->next_bucket = *bucket;
+   *bucket = string;
+   table->strings[ table->size ] = string;
+   ++table->size;
+   return string;
+}
+
+// The capacity of the hash table and of the index vector are the same, so
+// the load factor of the hash table never exceeds 1.
+static void grow_str_table( struct str_table* table ) {
+   enum { INITIAL_CAPACITY = 256 };
+   int capacity = ( table->capacity > 0 ) ?
+      table->capacity * 2 : INITIAL_CAPACITY;
+   struct indexed_string** buckets = mem_alloc( sizeof( *buckets ) *
+      capacity );
+   for ( int i = 0; i < capacity; ++i ) {
+      buckets[ i ] = NULL;
    }
-   else if ( parent_rchild ) {
-      parent_rchild->right = string;
+   for ( int i = 0; i < table->size; ++i ) {
+      struct indexed_string* string = table->strings[ i ];
+      struct indexed_string** bucket = &buckets[
+         t_hash_text( string->value, strlen( string->value ), false ) &
+         ( capacity - 1 ) ];
+      string->next_bucket = *bucket;
+      *bucket = string;
    }
-   else {
-      table->root = string;
+   if ( table->buckets ) {
+      mem_free( table->buckets );
    }
-   ++table->size;
-   return string;
+   table->buckets = buckets;
+   table->strings = mem_realloc( table->strings,
+      sizeof( *table->strings ) * capacity );
+   table->capacity = capacity;
 }
 
 struct indexed_string* t_intern_script_name( struct task* task,
@@ -862,14 +1085,15 @@ struct indexed_string* t_intern_script_name( struct task* task,
 }
 
 struct indexed_string* t_lookup_string( struct task* task, int index ) {
-   struct str_table* table = index / STRTABLE_MAXSIZE ==
-      STRTABLE_SCRIPTNAME ? &task->script_name_table : &task->str_table;
-   struct indexed_string* string = table->head;
-   while ( string ) {
-      if ( string->index == index ) {
-         return string;
-      }
-      string = string->next;
+   struct str_table* table = &task->str_table;
+   int position = index;
+   if ( index / STRTABLE_MAXSIZE == STRTABLE_SCRIPTNAME ) {
+      table = &task->script_name_table;
+      position -= STRTABLE_SCRIPTNAME * STRTABLE_MAXSIZE;
+   }
+   if ( position >= 0 && position < table->size &&
+      table->strings[ position ]->index == index ) {
+      return table->strings[ position ];
    }
    return NULL;
 }
@@ -997,16 +1221,23 @@ struct var* t_alloc_var( void ) {
    var->initial = NULL;
    var->value = NULL;
    var->next_instance = NULL;
+   list_init( &var->uses );
+   var->recorded_in = NULL;
    var->spec = SPEC_NONE;
    var->original_spec = SPEC_NONE;
    var->storage = STORAGE_LOCAL;
    var->index = 0;
    var->size = 0;
    var->diminfo_start = 0;
+   var->reads = 0;
+   var->folded_reads = 0;
    var->initz_zero = false;
    var->hidden = false;
    var->used = false;
+   var->reachable = false;
    var->modified = false;
+   var->element_modified = false;
+   var->immutable = false;
    var->initial_has_str = false;
    var->imported = false;
    var->is_constant_init = false;
@@ -1053,15 +1284,26 @@ struct func_user* t_alloc_func_user( void ) {
    impl->returns = NULL;
    impl->prologue_point = NULL;
    impl->return_table = NULL;
+   impl->return_jump = NULL;
+   impl->return_group = NULL;
    list_init( &impl->vars );
    list_init( &impl->funcscope_vars );
+   list_init( &impl->uses );
+   impl->recorded_in = NULL;
    impl->index = 0;
    impl->size = 0;
    impl->usage = 0;
    impl->obj_pos = 0;
+   impl->call_index = -1;
+   impl->call_lowlink = 0;
    impl->recursive = RECURSIVE_UNDETERMINED;
+   impl->purity = PURITY_UNDETERMINED;
+   impl->inlinable = INLINABLE_UNDETERMINED;
+   impl->inline_cost = 0;
    impl->nested = false;
    impl->local = false;
+   impl->direct_return = false;
+   impl->reachable = false;
    return impl;
 }
 
@@ -1104,7 +1346,9 @@ struct call* t_alloc_call( void ) {
    call->nested_call = NULL;
    call->format_item = NULL;
    list_init( &call->args );
+   call->value = 0;
    call->constant = false;
+   call->folded = false;
    return call;
 }
 
@@ -1112,6 +1356,16 @@ int t_dim_size( struct dim* dim ) {
    return dim->length * dim->element_size;
 }
 
+// Finds the initializer of the element at the offset of the variable. An
+// element without an initializer is zero.
+struct value* t_find_value( struct var* var, int offset ) {
+   struct value* value = var->value;
+   while ( value && value->index != offset ) {
+      value = value->next;
+   }
+   return value;
+}
+
 const struct lang_limits* t_get_lang_limits( int lang ) {
    static const struct lang_limits acs =
       { MAX_WORLD_VARS, MAX_GLOBAL_VARS, 1000, 4, 32768, 32767, 31 };
@@ -160,21 +160,60 @@ struct object {
    struct pos pos;
    struct object* next;
    struct object* next_scope;
+   // Unresolved object that stopped the last attempt at resolving this
+   // object.
+   struct object* dependency;
+   // Objects waiting on this object to get resolved, linked through
+   // `next_ready`.
+   struct object* dependents;
+   // Next object in the queue of the fragment, or next object waiting on the
+   // same dependency.
+   struct object* next_ready;
+   // Fragment whose unresolved list holds the object.
+   struct ns_fragment* fragment;
+};
+
+// An atom is an interned piece of name text. There is exactly one atom for
+// each distinct text, so two atoms can be compared by their address.
+struct atom {
+   struct atom* next;
+   // Atom of the same text in lowercase, found on first request.
+   struct atom* lowercase;
+   const char* text;
+   int length;
+   int id;
+   unsigned int hash;
 };
 
+// A name is a single component of a qualified name. The components form a
+// tree, with a root name at the top. A component is either the separator (a
+// dot) or an identifier. The children of a name are stored in a hash table,
+// keyed by the atom of the child.
 struct name {
    struct name* parent;
+   // Next name in the same bucket of the parent's hash table.
    struct name* next;
-   struct name* drop;
+   struct name** children;
    struct object* object;
-   char ch;
+   struct atom* atom;
+   // Fully qualified name, built on first request, with the internal
+   // separator separating the components.
+   char* full_name;
+   int full_name_length;
+   int full_name_separators;
+   int num_children;
+   int children_capacity;
 };
 
 struct name_usage {
    struct node node;
    const char* text;
+   struct atom* atom;
    struct node* object;
    struct pos pos;
+   // Set when the reference is known to be non-null where it is used, so
+   // the null check can be skipped.
+   bool non_null;
 };
 
 struct qualified_name_usage {
@@ -186,6 +225,7 @@ struct qualified_name_usage {
 struct path {
    struct path* next;
    const char* text;
+   struct atom* atom;
    struct pos pos;
    bool upmost;
    bool current_ns;
@@ -439,6 +479,9 @@ struct logical {
    int rside_spec;
    int value;
    bool folded;
+   // The right operand can assign a reference known to be non-null, so what
+   // the left operand tells about references does not hold afterwards.
+   bool rside_changes_refs;
 };
 
 struct assign {
@@ -486,7 +529,10 @@ struct subscript {
    struct node node;
    struct node* lside;
    struct expr* index;
+   // Map array read at a constant element offset.
+   struct var* var;
    struct pos pos;
+   int offset;
    bool string;
 };
 
@@ -496,6 +542,7 @@ struct access {
    struct node* lside;
    struct node* rside;
    const char* name;
+   struct atom* atom;
    enum {
       ACCESS_STRUCTURE,
       ACCESS_NAMESPACE,
@@ -513,14 +560,23 @@ struct call {
    struct nested_call* nested_call;
    struct format_item* format_item;
    struct list args;
+   // Result of a call to a pure function, evaluated at compile time.
+   int value;
    bool constant;
+   bool folded;
 };
 
 struct nested_call {
    struct call* next;
+   // Local nested function that makes the call. NULL when the call is made
+   // elsewhere.
+   struct func* caller;
    struct c_jump* prologue_jump;
    struct c_point* return_point;
    int id;
+   // The call is the value of a return statement of a nested function, so the
+   // called function can return straight to the callers of that function.
+   bool tail;
 };
 
 // I would like to make this a function.
@@ -644,7 +700,6 @@ struct case_label {
    struct node node;
    int offset;
    struct expr* number;
-   struct case_label* next;
    struct c_point* point;
    struct pos pos;
 };
@@ -653,9 +708,10 @@ struct switch_stmt {
    struct node node;
    struct heavy_cond cond;
    // Cases are sorted by their value, in ascending order. Default case not
-   // included in this list.
-   struct case_label* case_head;
+   // included in this array.
+   struct case_label** cases;
    struct case_label* case_default;
+   int num_cases;
    struct jump* jump_break;
    struct node* body;
 };
@@ -797,12 +853,19 @@ struct var {
    struct initial* initial;
    struct value* value;
    struct var* next_instance;
+   // Map variables and user functions used by the initializer.
+   struct list uses;
+   // Last list of uses the variable was added to.
+   struct list* recorded_in;
    int spec;
    int original_spec;
    int storage;
    int index;
    int size;
    int diminfo_start;
+   // Reads of the variable, and how many of them use a constant element.
+   int reads;
+   int folded_reads;
    enum {
       DESC_NONE,
       DESC_ARRAY,
@@ -813,7 +876,12 @@ struct var {
    bool initz_zero;
    bool hidden;
    bool used;
+   // Reachable from a script or an exported object.
+   bool reachable;
    bool modified;
+   bool element_modified;
+   // Never written after initialization, so reads use the initial value.
+   bool immutable;
    bool initial_has_str;
    bool imported;
    bool is_constant_init;
@@ -938,18 +1006,52 @@ struct func_user {
    struct return_stmt* returns;
    struct c_point* prologue_point;
    struct c_sortedcasejump* return_table;
+   struct c_jump* return_jump;
+   // Nested functions joined by tail calls return to the same places, and
+   // share the return-table. NULL when the function leads its group.
+   struct func* return_group;
    struct list vars;
    struct list funcscope_vars;
+   // Map variables and user functions used by the function, including its
+   // nested functions and default arguments. A call that might be evaluated
+   // at compile time is listed instead of the called function.
+   struct list uses;
+   // Last list of uses the function was added to.
+   struct list* recorded_in;
    int index;
    int size;
    int usage;
    int obj_pos;
+   // Used when searching for the nested functions that are part of a call
+   // cycle.
+   int call_index;
+   int call_lowlink;
    enum {
       RECURSIVE_UNDETERMINED,
       RECURSIVE_POSSIBLY
    } recursive;
+   enum {
+      PURITY_UNDETERMINED,
+      PURITY_PURE,
+      PURITY_IMPURE
+   } purity;
+   enum {
+      INLINABLE_UNDETERMINED,
+      INLINABLE_TESTING,
+      // Reached from its own body while being tested.
+      INLINABLE_RECURSIVE,
+      INLINABLE_YES,
+      INLINABLE_NO
+   } inlinable;
+   // Estimated size of the body, used when deciding whether to inline.
+   int inline_cost;
    bool nested;
    bool local;
+   // The nested function has a single place to return to, so it jumps there
+   // instead of using the return-table.
+   bool direct_return;
+   // Reachable from a script or an exported object.
+   bool reachable;
 };
 
 struct func_intern {
@@ -1010,6 +1112,7 @@ struct label {
    struct node node;
    struct pos pos;
    const char* name;
+   struct atom* atom;
    struct buildmsg* buildmsg;
    struct c_point* point;
    // goto statements that use this label.
@@ -1021,6 +1124,7 @@ struct goto_stmt {
    int obj_pos;
    struct label* label;
    const char* label_name;
+   struct atom* label_atom;
    struct pos pos;
    struct pos label_name_pos;
    struct buildmsg* buildmsg;
@@ -1089,8 +1193,8 @@ struct constant {
 
 struct indexed_string {
    struct indexed_string* next;
-   struct indexed_string* left;
-   struct indexed_string* right;
+   // Next string in the same bucket of the string table.
+   struct indexed_string* next_bucket;
    const char* value;
    int length;
    int index;
@@ -1107,7 +1211,11 @@ struct indexed_string_usage {
 struct str_table {
    struct indexed_string* head;
    struct indexed_string* tail;
-   struct indexed_string* root;
+   // Hash table of the strings, for interning.
+   struct indexed_string** buckets;
+   // The strings, in order of interning, for lookup by index.
+   struct indexed_string** strings;
+   int capacity;
    int size;
 };
 
@@ -1142,6 +1250,8 @@ struct inline_asm_arg {
       struct param* param;
       struct func* func;
    } value;
+   // Atom of the identifier, for an INLINE_ASM_ARG_ID argument.
+   struct atom* atom;
    struct pos pos;
 };
 
@@ -1178,8 +1288,14 @@ struct ns_fragment {
    struct object object;
    struct ns* ns;
    struct ns_path* path;
+   // Unresolved objects, in declaration order.
    struct object* unresolved;
    struct object* unresolved_tail;
+   // Unresolved objects to test in the next pass. Objects waiting on another
+   // object are not in the queue, only counted.
+   struct object* ready;
+   struct object* ready_tail;
+   int waiting;
    struct list objects;
    struct list funcs;
    struct list scripts;
@@ -1195,6 +1311,7 @@ struct ns_fragment {
 struct ns_path {
    struct ns_path* next;
    const char* text;
+   struct atom* atom;
    struct pos pos;
    bool dot_separator;
 };
@@ -1214,6 +1331,8 @@ struct using_dirc {
 struct using_item {
    const char* name;
    const char* usage_name;
+   struct atom* atom;
+   struct atom* usage_atom;
    struct alias* alias;
    struct pos pos;
    enum {
@@ -1365,6 +1484,12 @@ void t_find_file( struct task* task, struct file_query* query );
 struct library* t_add_library( struct task* task );
 struct name* t_create_name( void );
 struct name* t_extend_name( struct name* parent, const char* extension );
+struct name* t_extend_name_atom( struct name* parent, struct atom* atom );
+struct name* t_find_name_atom( struct name* parent, struct atom* atom );
+void t_reserve_name_children( struct name* parent, int count );
+struct atom* t_intern_atom( const char* text, int length );
+unsigned int t_hash_text( const char* text, int length, bool fold_case );
+struct atom* t_lowercase_atom( struct atom* atom );
 struct indexed_string* t_intern_string( struct task* task,
    const char* value, int length );
 struct indexed_string* t_intern_string_copy( struct task* task,
@@ -1373,6 +1498,8 @@ struct indexed_string* t_lookup_string( struct task* task, int index );
 struct ns* t_alloc_ns( struct name* name );
 void t_append_unresolved_namespace_object( struct ns_fragment* fragment,
    struct object* object );
+void t_queue_unresolved_namespace_object( struct ns_fragment* fragment,
+   struct object* object );
 struct constant* t_alloc_constant( void );
 struct enumeration* t_alloc_enumeration( void );
 struct enumerator* t_alloc_enumerator( void );
@@ -1390,6 +1517,7 @@ struct param* t_alloc_param( void );
 struct format_item* t_alloc_format_item( void );
 struct call* t_alloc_call( void );
 int t_dim_size( struct dim* dim );
+struct value* t_find_value( struct var* var, int offset );
 const struct lang_limits* t_get_lang_limits( int lang );
 const char* t_get_storage_name( int storage );
 struct literal* t_alloc_literal( void );
@@ -0,0 +1,365 @@
+#!/usr/bin/env python3
+# Compiles each sample in this directory at several optimization levels and
+# compares a listing of the object file with the expected listing in the
+# `expected` directory. The listing shows the instructions of each script and
+# function, with jump targets as labels, and the contents of the chunks.
+#
+# Usage: run.py <compiler> [--update]
+#
+# With --update, the expected listings are rewritten from the current output.
+#
+# A sample can start with these comments:
+#   // options: <compiler options>
+#   // levels: <optimization levels, default 0 1>
+
+import difflib
+import os
+import re
+import struct
+import subprocess
+import sys
+import tempfile
+
+TEST_DIR = os.path.dirname( os.path.abspath( __file__ ) )
+ROOT_DIR = os.path.dirname( os.path.dirname( TEST_DIR ) )
+SRC_DIR = os.path.join( ROOT_DIR, 'src', 'codegen' )
+
+# Opcodes
+# ===========================================================================
+
+def read_opcodes():
+   header = open( os.path.join( SRC_DIR, 'pcode.h' ) ).read()
+   body = header[ header.index( 'enum {' ) : header.index( '};' ) ]
+   names = re.findall( r'PCD_(\w+)', body )
+   table = open( os.path.join( SRC_DIR, 'pcode.c' ) ).read()
+   argc = {}
+   for name, count in re.findall(
+      r'\{\s*PCD_(\w+),\s*(-?[0-9]+|VARIABLE_ARGC),', table ):
+      argc[ name ] = -1 if count == 'VARIABLE_ARGC' else int( count )
+   return names, argc
+
+OPCODES, ARGC = read_opcodes()
+
+# Arguments that are always a single byte.
+BYTE_ARGS = { 'PUSHBYTE', 'PUSH2BYTES', 'PUSH3BYTES', 'PUSH4BYTES',
+   'PUSH5BYTES', 'LSPEC1DIRECTB', 'LSPEC2DIRECTB', 'LSPEC3DIRECTB',
+   'LSPEC4DIRECTB', 'LSPEC5DIRECTB', 'DELAYDIRECTB', 'RANDOMDIRECTB' }
+# Instructions whose only argument is a byte in the Little-E format.
+COMPRESSED_BYTE_ARGS = { 'CALL', 'CALLDISCARD', 'PUSHFUNCTION' }
+VARIABLE_OP = re.compile( r'^(PUSH|ASSIGN|ADD|SUB|MUL|DIV|MOD|LS|RS|AND|EOR|'
+   r'OR|INC|DEC)(SCRIPT|MAP|WORLD|GLOBAL)(VAR|ARRAY)$' )
+# Instructions whose first argument is a byte in the Little-E format.
+COMPRESSED_FIRST_BYTE_ARGS = { 'LSPEC1', 'LSPEC2', 'LSPEC3', 'LSPEC4',
+   'LSPEC5', 'LSPEC5RESULT', 'LSPEC1DIRECT', 'LSPEC2DIRECT', 'LSPEC3DIRECT',
+   'LSPEC4DIRECT', 'LSPEC5DIRECT' }
+JUMPS = { 'GOTO', 'IFGOTO', 'IFNOTGOTO' }
+
+# Object file
+# ===========================================================================
+
+class Object:
+   def __init__( self, data ):
+      self.data = data
+      self.format = 'ACS0'
+      self.compressed = False
+      self.chunks = []
+      self.entries = {}
+      self.func_names = []
+      dir_offset = self.int( 4 )
+      if data[ dir_offset - 4 : dir_offset ] in ( b'ACSE', b'ACSe' ):
+         self.format = data[ dir_offset - 4 : dir_offset ].decode()
+         self.compressed = ( self.format == 'ACSe' )
+         self.code_end = self.int( dir_offset - 8 )
+         self.read_chunks( self.code_end )
+      else:
+         self.code_end = dir_offset
+         self.read_directory( dir_offset )
+
+   def int( self, pos ):
+      return struct.unpack_from( '<i', self.data, pos )[ 0 ]
+
+   def read_directory( self, pos ):
+      count = self.int( pos )
+      for i in range( count ):
+         number, offset, argc = struct.unpack_from( '<iii', self.data,
+            pos + 4 + i * 12 )
+         self.entries[ offset ] = 'script %d, type %d (%d args)' % (
+            number % 1000, number // 1000, argc )
+      pos += 4 + count * 12
+      count = self.int( pos )
+      strings = []
+      for i in range( count ):
+         strings.append( self.cstr( self.int( pos + 4 + i * 4 ) ) )
+      self.chunks.append( ( 'STRINGS', strings ) )
+
+   def read_chunks( self, pos ):
+      while pos + 8 <= len( self.data ):
+         name = self.data[ pos : pos + 4 ]
+         size = self.int( pos + 4 )
+         if not re.match( rb'^[A-Z]{4}$', name ) or size < 0:
+            break
+         self.chunks.append( ( name.decode(),
+            self.data[ pos + 8 : pos + 8 + size ] ) )
+         pos += 8 + size
+      for name, body in self.chunks:
+         if name == 'FNAM':
+            self.func_names = names_at_offsets( body )
+      snam = []
+      for name, body in self.chunks:
+         if name == 'SNAM':
+            snam = names_at_offsets( body )
+      for name, body in self.chunks:
+         if name == 'SPTR':
+            for pos in range( 0, len( body ), 8 ):
+               number, kind, argc, offset = struct.unpack_from( '<hBBi',
+                  body, pos )
+               if number < 0 and -number - 1 < len( snam ):
+                  title = 'script "%s"' % snam[ -number - 1 ]
+               else:
+                  title = 'script %d' % number
+               self.entries[ offset ] = '%s, type %d (%d args)' % ( title,
+                  kind, argc )
+         elif name == 'FUNC':
+            for index in range( len( body ) // 8 ):
+               argc, size, value, _, offset = struct.unpack_from( '<BBBBi',
+                  body, index * 8 )
+               if offset:
+                  self.entries[ offset ] = 'function %s (%d args, %d ' \
+                     'locals%s)' % ( self.func_name( index ), argc, size,
+                     ', returns value' if value else '' )
+
+   def func_name( self, index ):
+      if index < len( self.func_names ):
+         return '%d "%s"' % ( index, self.func_names[ index ] )
+      return '%d' % index
+
+   def cstr( self, pos ):
+      end = self.data.index( b'\0', pos )
+      return text( self.data[ pos : end ] )
+
+# Strings are shown as UTF-8. Bytes that are not valid UTF-8 are escaped.
+def text( raw ):
+   return raw.decode( 'utf-8', 'backslashreplace' )
+
+def names_at_offsets( body ):
+   count = struct.unpack_from( '<i', body, 0 )[ 0 ]
+   names = []
+   for i in range( count ):
+      offset = struct.unpack_from( '<i', body, 4 + i * 4 )[ 0 ]
+      names.append( text( body[ offset : body.index( b'\0', offset ) ] ) )
+   return names
+
+# Listing
+# ===========================================================================
+
+def decode( obj ):
+   data = obj.data
+   pos = 8
+   instructions = []
+   # The code can be followed by zeros that pad the chunks.
+   end = obj.code_end
+   while end > pos and data[ end - 1 ] == 0:
+      end -= 1
+   while pos < end:
+      start = pos
+      if obj.compressed:
+         code = data[ pos ]
+         pos += 1
+         if code >= 240:
+            code = 240 + data[ pos ]
+            pos += 1
+      else:
+         code = obj.int( pos )
+         pos += 4
+      name = OPCODES[ code ] if code < len( OPCODES ) else '?%d' % code
+      args = []
+      labels = []
+      if name == 'PUSHBYTES':
+         count = data[ pos ]
+         args = list( data[ pos + 1 : pos + 1 + count ] )
+         pos += 1 + count
+      elif name == 'CASEGOTOSORTED':
+         pos += ( 4 - pos % 4 ) % 4
+         count = obj.int( pos )
+         pos += 4
+         for i in range( count ):
+            args.append( obj.int( pos ) )
+            labels.append( obj.int( pos + 4 ) )
+            pos += 8
+      else:
+         for i in range( max( ARGC.get( name, 0 ), 0 ) ):
+            if name in BYTE_ARGS or ( obj.compressed and (
+               name in COMPRESSED_BYTE_ARGS or VARIABLE_OP.match( name ) or
+               ( name in COMPRESSED_FIRST_BYTE_ARGS and i == 0 ) or
+               ( name == 'CALLFUNC' and i == 0 ) ) ):
+               args.append( data[ pos ] )
+               pos += 1
+            elif obj.compressed and name == 'CALLFUNC':
+               args.append( struct.unpack_from( '<h', data, pos )[ 0 ] )
+               pos += 2
+            else:
+               args.append( obj.int( pos ) )
+               pos += 4
+         if name in JUMPS:
+            labels = [ args.pop() ]
+         elif name == 'CASEGOTO':
+            labels = [ args.pop() ]
+      instructions.append( ( start, name, args, labels ) )
+   return instructions
+
+def list_code( obj ):
+   instructions = decode( obj )
+   targets = sorted( { label for _, _, _, labels in instructions
+      for label in labels } )
+   label_names = { target: 'L%d' % ( i + 1 ) for i, target in enumerate(
+      targets ) }
+   lines = []
+   for start, name, args, labels in instructions:
+      if start in obj.entries:
+         lines.append( obj.entries[ start ] + ':' )
+      prefix = ( label_names[ start ] + ':' ) if start in label_names else ''
+      text = [ str( arg ) for arg in args ]
+      if name == 'CASEGOTOSORTED':
+         text = [ '%d->%s' % ( value, label_names.get( label, label ) )
+            for value, label in zip( args, labels ) ]
+      else:
+         text += [ label_names.get( label, str( label ) ) for label in
+            labels ]
+      if name in ( 'CALL', 'CALLDISCARD', 'PUSHFUNCTION' ) and args:
+         text = [ obj.func_name( args[ 0 ] ) ]
+      lines.append( ( '%-6s %s %s' % ( prefix, name, ' '.join(
+         text ) ) ).rstrip() )
+   return lines
+
+def list_chunks( obj ):
+   lines = []
+   for name, body in obj.chunks:
+      if name == 'STRINGS':
+         lines.append( 'strings:' )
+         lines += [ '   %d "%s"' % ( i, string ) for i, string in enumerate(
+            body ) ]
+         continue
+      if name in ( 'SPTR', 'FUNC', 'SNAM', 'FNAM' ):
+         # Shown with the code.
+         if name == 'FUNC':
+            lines.append( 'FUNC: %d functions' % ( len( body ) // 8 ) )
+            for index in range( len( body ) // 8 ):
+               if struct.unpack_from( '<i', body, index * 8 + 4 )[ 0 ] == 0:
+                  lines.append( '   %s imported' % obj.func_name( index ) )
+         continue
+      if name in ( 'STRL', 'STRE' ):
+         count = struct.unpack_from( '<i', body, 4 )[ 0 ]
+         lines.append( '%s: %d strings' % ( name, count ) )
+         for i in range( count ):
+            offset = struct.unpack_from( '<i', body, 12 + i * 4 )[ 0 ]
+            if name == 'STRE':
+               value = decrypt( body, offset )
+            else:
+               value = text( body[ offset : body.index( b'\0', offset ) ] )
+            lines.append( '   %d "%s"' % ( i, value ) )
+      elif name in ( 'MEXP', 'LOAD' ):
+         if name == 'MEXP':
+            names = names_at_offsets( body )
+         else:
+            names = [ text( n ) for n in body.split( b'\0' ) if n ]
+         lines.append( '%s: %s' % ( name, ' '.join( names ) ) )
+      elif name == 'MIMP':
+         items = []
+         pos = 0
+         while pos + 4 < len( body ):
+            index = struct.unpack_from( '<i', body, pos )[ 0 ]
+            end = body.index( b'\0', pos + 4 )
+            items.append( '%d=%s' % ( index, text( body[ pos + 4 : end ] ) ) )
+            pos = end + 1
+         lines.append( 'MIMP: %s' % ' '.join( items ) )
+      else:
+         words = [ str( w ) for w in struct.unpack_from(
+            '<%di' % ( len( body ) // 4 ), body ) ]
+         lines.append( ( '%s: %s' % ( name, ' '.join( words ) ) ).rstrip() )
+   return lines
+
+def decrypt( body, offset ):
+   key = offset * 157135
+   chars = bytearray()
+   i = 0
+   while True:
+      ch = ( body[ offset + i ] ^ ( ( key + i // 2 ) & 0xFF ) )
+      if ch == 0:
+         break
+      chars.append( ch )
+      i += 1
+   return text( bytes( chars ) )
+
+def make_listing( path ):
+   obj = Object( open( path, 'rb' ).read() )
+   lines = [ 'format: %s' % obj.format ]
+   lines += list_code( obj )
+   lines += list_chunks( obj )
+   return '\n'.join( lines ) + '\n'
+
+# Samples
+# ===========================================================================
+
+def read_settings( source ):
+   options = []
+   levels = [ '0', '1' ]
+   for line in open( source, encoding = 'utf-8' ):
+      match = re.match( r'\s*//\s*(options|levels):(.*)', line )
+      if not match:
+         break
+      if match.group( 1 ) == 'options':
+         options = match.group( 2 ).split()
+      else:
+         levels = match.group( 2 ).split()
+   return options, levels
+
+def main():
+   if len( sys.argv ) < 2:
+      print( 'usage: %s <compiler> [--update]' % sys.argv[ 0 ] )
+      return 2
+   compiler = os.path.abspath( sys.argv[ 1 ] )
+   update = ( '--update' in sys.argv[ 2 : ] )
+   failed = 0
+   samples = sorted( f for f in os.listdir( TEST_DIR )
+      if f.endswith( ( '.bcs', '.acs' ) ) )
+   with tempfile.TemporaryDirectory() as temp_dir:
+      output = os.path.join( temp_dir, 'test.o' )
+      for sample in samples:
+         source = os.path.join( TEST_DIR, sample )
+         name = os.path.splitext( sample )[ 0 ]
+         options, levels = read_settings( source )
+         for level in levels:
+            command = [ compiler, '-O', level, '-i',
+               os.path.join( ROOT_DIR, 'lib' ) ] + options + [ source,
+               output ]
+            result = subprocess.run( command, stdout = subprocess.PIPE,
+               stderr = subprocess.STDOUT, universal_newlines = True )
+            if result.returncode != 0:
+               print( 'failed: %s at -O %s\n%s' % ( sample, level,
+                  result.stdout ) )
+               failed += 1
+               continue
+            listing = make_listing( output )
+            expected_path = os.path.join( TEST_DIR, 'expected',
+               '%s.O%s.txt' % ( name, level ) )
+            if update:
+               with open( expected_path, 'w',
+                  encoding = 'utf-8' ) as expected_file:
+                  expected_file.write( listing )
+               continue
+            expected = ''
+            if os.path.exists( expected_path ):
+               expected = open( expected_path, encoding = 'utf-8' ).read()
+            if listing != expected:
+               print( 'failed: %s at -O %s' % ( sample, level ) )
+               sys.stdout.writelines( difflib.unified_diff(
+                  expected.splitlines( True ), listing.splitlines( True ),
+                  expected_path, 'output' ) )
+               failed += 1
+   if failed:
+      print( '%d of the sample compilations failed' % failed )
+      return 1
+   return 0
+
+if __name__ == '__main__':
+   sys.exit( main() )